@@ -0,0 +1,229 @@
+﻿#include "CodeGen.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace
+{
+    using namespace std;
+
+    string GetStateLabel(int state)
+    {
+        return "s" + to_string(state);
+    }
+
+    string GetCharLiteral(char symbol)
+    {
+        return to_string(int(static_cast<unsigned char>(symbol)));
+    }
+
+    void WriteHeader(const CodegenTable& table, ostream& output)
+    {
+        output << "// Generated from a " << (table.IsTransducer() ? "Mealy machine" : "DFA")
+            << " with " << table.stateCount << " states, do not edit.\n";
+        output << "#pragma once\n";
+        output << "#include <cstddef>\n\n";
+        output << "namespace " << table.name << "\n{\n";
+    }
+
+    void WriteSignature(const CodegenTable& table, ostream& output)
+    {
+        if (table.IsTransducer())
+        {
+            output << "    inline std::size_t Run(const char* p, const char* end, char* out)\n    {\n";
+            output << "        char* const first = out;\n";
+        }
+        else
+        {
+            output << "    inline bool Match(const char* p, const char* end)\n    {\n";
+        }
+    }
+
+    void GenerateDirect(const CodegenTable& table, ostream& output)
+    {
+        const size_t symbolCount = table.symbols.size();
+        const string stop = table.IsTransducer() ? "return std::size_t(out - first);" : "return false;";
+
+        vector<bool> referenced(table.stateCount, false);
+        referenced[table.startState] = true;
+        for (int target : table.next)
+        {
+            if (target >= 0)
+            {
+                referenced[target] = true;
+            }
+        }
+
+        WriteHeader(table, output);
+        WriteSignature(table, output);
+        output << "        goto " << GetStateLabel(table.startState) << ";\n";
+
+        for (int state = 0; state < table.stateCount; state++)
+        {
+            if (!referenced[state])
+            {
+                continue;
+            }
+
+            output << "    " << GetStateLabel(state) << ":\n";
+            output << "        if (p == end)\n        {\n            ";
+            if (table.IsTransducer())
+            {
+                output << stop;
+            }
+            else
+            {
+                output << "return " << (table.accepting[state] ? "true" : "false") << ";";
+            }
+            output << "\n        }\n";
+            output << "        switch (static_cast<unsigned char>(*p++))\n        {\n";
+
+            for (size_t i = 0; i < symbolCount; i++)
+            {
+                int target = table.next[state * symbolCount + i];
+                if (target < 0)
+                {
+                    continue;
+                }
+                output << "        case " << GetCharLiteral(table.symbols[i]) << ":\n";
+                if (table.IsTransducer())
+                {
+                    output << "            *out++ = char(" << GetCharLiteral(table.outputs[state * symbolCount + i]) << ");\n";
+                }
+                output << "            goto " << GetStateLabel(target) << ";\n";
+            }
+
+            output << "        default:\n            " << stop << "\n        }\n";
+        }
+
+        output << "    }\n}\n";
+    }
+
+    // Номер первого символа каждого класса
+    vector<size_t> GetClassRepresentatives(const CodegenTable& table)
+    {
+        const size_t classCount = table.symbolClasses.empty()
+            ? 0 : size_t(*max_element(table.symbolClasses.begin(), table.symbolClasses.end())) + 1;
+        vector<size_t> representatives(classCount, table.symbols.size());
+        for (size_t i = table.symbols.size(); i-- > 0;)
+        {
+            representatives[table.symbolClasses[i]] = i;
+        }
+        if (find(representatives.begin(), representatives.end(), table.symbols.size()) != representatives.end())
+        {
+            throw invalid_argument("Symbol classes should be numbered without gaps");
+        }
+        return representatives;
+    }
+
+    void GenerateTable(const CodegenTable& table, ostream& output)
+    {
+        const size_t symbolCount = table.symbols.size();
+        const string nextType = table.stateCount < 0x7fff ? "short" : "int";
+
+        const vector<size_t> representatives = GetClassRepresentatives(table);
+        const size_t classCount = representatives.size();
+
+        // Класс 0 - символы вне алфавита, из него переходов нет
+        vector<int> classOf(256, 0);
+        for (size_t i = 0; i < symbolCount; i++)
+        {
+            classOf[static_cast<unsigned char>(table.symbols[i])] = table.symbolClasses[i] + 1;
+        }
+
+        WriteHeader(table, output);
+
+        output << "    inline constexpr unsigned char kClass[256] = {";
+        for (int c = 0; c < 256; c++)
+        {
+            output << (c % 32 == 0 ? "\n        " : " ") << classOf[c] << ",";
+        }
+        output << "\n    };\n\n";
+
+        output << "    inline constexpr " << nextType << " kNext[" << table.stateCount << "][" << classCount + 1 << "] = {\n";
+        for (int state = 0; state < table.stateCount; state++)
+        {
+            output << "        { -1,";
+            for (size_t i : representatives)
+            {
+                output << " " << table.next[state * symbolCount + i] << ",";
+            }
+            output << " },\n";
+        }
+        output << "    };\n\n";
+
+        if (table.IsTransducer())
+        {
+            output << "    inline constexpr char kOutput[" << table.stateCount << "][" << classCount + 1 << "] = {\n";
+            for (int state = 0; state < table.stateCount; state++)
+            {
+                output << "        { 0,";
+                for (size_t i : representatives)
+                {
+                    output << " char(" << GetCharLiteral(table.outputs[state * symbolCount + i]) << "),";
+                }
+                output << " },\n";
+            }
+            output << "    };\n\n";
+        }
+        else
+        {
+            output << "    inline constexpr bool kAccept[" << table.stateCount << "] = {";
+            for (int state = 0; state < table.stateCount; state++)
+            {
+                output << (state % 16 == 0 ? "\n        " : " ") << (table.accepting[state] ? "true" : "false") << ",";
+            }
+            output << "\n    };\n\n";
+        }
+
+        WriteSignature(table, output);
+        output << "        int state = " << table.startState << ";\n";
+        output << "        for (; p != end; ++p)\n        {\n";
+        output << "            const unsigned char symbol = kClass[static_cast<unsigned char>(*p)];\n";
+        output << "            const int next = kNext[state][symbol];\n";
+        output << "            if (next < 0)\n            {\n";
+        output << (table.IsTransducer() ? "                break;\n" : "                return false;\n");
+        output << "            }\n";
+        if (table.IsTransducer())
+        {
+            output << "            *out++ = kOutput[state][symbol];\n";
+        }
+        output << "            state = next;\n        }\n";
+        output << (table.IsTransducer() ? "        return std::size_t(out - first);\n" : "        return kAccept[state];\n");
+        output << "    }\n}\n";
+    }
+}
+
+CodegenStyle ParseCodegenStyle(const string& style)
+{
+    if (style == "direct")
+    {
+        return CodegenStyle::Direct;
+    }
+    if (style == "table")
+    {
+        return CodegenStyle::Table;
+    }
+    throw invalid_argument("Code style should be direct or table");
+}
+
+void GenerateCode(const CodegenTable& table, CodegenStyle style, ostream& output)
+{
+    if (table.stateCount == 0)
+    {
+        throw invalid_argument("Cannot generate code for an empty machine");
+    }
+    if (table.symbolClasses.size() != table.symbols.size()
+        || any_of(table.symbolClasses.begin(), table.symbolClasses.end(), [](int symbolClass) { return symbolClass < 0; }))
+    {
+        throw invalid_argument("Every symbol needs a symbol class");
+    }
+
+    if (style == CodegenStyle::Direct)
+    {
+        GenerateDirect(table, output);
+    }
+    else
+    {
+        GenerateTable(table, output);
+    }
+}
@@ -0,0 +1,42 @@
+﻿#pragma once
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Таблица переходов, по которой генерируется исходный код распознавателя (DFA)
+// или преобразователя (Mealy). Переход state по symbols[i] лежит в next[state * symbols.size() + i].
+struct CodegenTable
+{
+    std::string name;
+    int stateCount = 0;
+    int startState = 0;
+    std::vector<char> symbols;
+    // Класс каждого символа из symbols, классы нумеруются с 0 подряд. Символы одного класса
+    // переходят (и выводят) одинаково во всех состояниях; классы считает вызывающий
+    std::vector<int> symbolClasses;
+    // -1, если перехода нет
+    std::vector<int> next;
+    // Выходы переходов автомата Мили, для DFA пусто
+    std::vector<char> outputs;
+    // Заключительные состояния DFA, для автомата Мили пусто
+    std::vector<bool> accepting;
+
+    bool IsTransducer() const
+    {
+        return accepting.empty();
+    }
+};
+
+enum class CodegenStyle
+{
+    // switch/goto на каждое состояние
+    Direct,
+    // упакованные константные таблицы
+    Table,
+};
+
+CodegenStyle ParseCodegenStyle(const std::string& style);
+
+// DFA: bool <name>::Match(const char* begin, const char* end)
+// Mealy: size_t <name>::Run(const char* begin, const char* end, char* out) - число записанных выходов
+void GenerateCode(const CodegenTable& table, CodegenStyle style, std::ostream& output);
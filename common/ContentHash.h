@@ -0,0 +1,113 @@
+﻿#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+
+struct Hash128
+{
+    uint64_t high;
+    uint64_t low;
+
+    bool operator==(const Hash128& other) const = default;
+
+    std::string ToString() const
+    {
+        std::ostringstream stream;
+        stream << std::hex << std::setfill('0') << std::setw(16) << high << std::setw(16) << low;
+        return stream.str();
+    }
+};
+
+// Байты канонической формы: числа little-endian, строки с длиной впереди
+inline void AppendUint32(std::vector<uint8_t>& bytes, uint32_t value)
+{
+    for (int i = 0; i < 4; i++)
+    {
+        bytes.push_back(uint8_t(value >> (8 * i)));
+    }
+}
+
+inline void AppendString(std::vector<uint8_t>& bytes, const std::string& value)
+{
+    AppendUint32(bytes, uint32_t(value.size()));
+    bytes.insert(bytes.end(), value.begin(), value.end());
+}
+
+namespace ContentHashDetail
+{
+    inline uint64_t Rotl(uint64_t x, int r)
+    {
+        return (x << r) | (x >> (64 - r));
+    }
+
+    inline uint64_t Mix(uint64_t k)
+    {
+        k ^= k >> 33;
+        k *= 0xff51afd7ed558ccdULL;
+        k ^= k >> 33;
+        k *= 0xc4ceb9fe1a85ec53ULL;
+        k ^= k >> 33;
+        return k;
+    }
+}
+
+// MurmurHash3 x64 128
+inline Hash128 HashBytes(const std::vector<uint8_t>& bytes)
+{
+    using ContentHashDetail::Rotl;
+    using ContentHashDetail::Mix;
+
+    const uint64_t c1 = 0x87c37b91114253d5ULL;
+    const uint64_t c2 = 0x4cf5ad432745937fULL;
+    const size_t blockCount = bytes.size() / 16;
+    uint64_t h1 = 0, h2 = 0;
+
+    for (size_t i = 0; i < blockCount; i++)
+    {
+        uint64_t k1 = 0, k2 = 0;
+        for (int b = 7; b >= 0; b--)
+        {
+            k1 = (k1 << 8) | bytes[i * 16 + b];
+            k2 = (k2 << 8) | bytes[i * 16 + 8 + b];
+        }
+
+        k1 *= c1; k1 = Rotl(k1, 31); k1 *= c2; h1 ^= k1;
+        h1 = Rotl(h1, 27); h1 += h2; h1 = h1 * 5 + 0x52dce729;
+        k2 *= c2; k2 = Rotl(k2, 33); k2 *= c1; h2 ^= k2;
+        h2 = Rotl(h2, 31); h2 += h1; h2 = h2 * 5 + 0x38495ab5;
+    }
+
+    const size_t tail = blockCount * 16;
+    const size_t rest = bytes.size() & 15;
+    uint64_t k1 = 0, k2 = 0;
+    for (size_t b = rest; b > 8; b--)
+    {
+        k2 = (k2 << 8) | bytes[tail + b - 1];
+    }
+    for (size_t b = std::min<size_t>(rest, 8); b > 0; b--)
+    {
+        k1 = (k1 << 8) | bytes[tail + b - 1];
+    }
+    if (rest > 8)
+    {
+        k2 *= c2; k2 = Rotl(k2, 33); k2 *= c1; h2 ^= k2;
+    }
+    if (rest > 0)
+    {
+        k1 *= c1; k1 = Rotl(k1, 31); k1 *= c2; h1 ^= k1;
+    }
+
+    h1 ^= bytes.size();
+    h2 ^= bytes.size();
+    h1 += h2;
+    h2 += h1;
+    h1 = Mix(h1);
+    h2 = Mix(h2);
+    h1 += h2;
+    h2 += h1;
+
+    return { h2, h1 };
+}
@@ -0,0 +1,114 @@
+﻿#pragma once
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Файл, отображённый в память только для чтения. Пустой файл не отображается, Data() == nullptr.
+class MappedFile
+{
+public:
+    explicit MappedFile(const std::string& fileName)
+    {
+#ifdef _WIN32
+        HANDLE file = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+            FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+        {
+            throw std::runtime_error("Failed to open file " + fileName);
+        }
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file, &size))
+        {
+            CloseHandle(file);
+            throw std::runtime_error("Failed to get size of file " + fileName);
+        }
+        m_size = size_t(size.QuadPart);
+        if (m_size != 0)
+        {
+            HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (mapping != nullptr)
+            {
+                m_data = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+                CloseHandle(mapping);
+            }
+        }
+        CloseHandle(file);
+#else
+        int file = open(fileName.c_str(), O_RDONLY);
+        if (file < 0)
+        {
+            throw std::runtime_error("Failed to open file " + fileName);
+        }
+        struct stat info;
+        if (fstat(file, &info) != 0)
+        {
+            close(file);
+            throw std::runtime_error("Failed to get size of file " + fileName);
+        }
+        m_size = size_t(info.st_size);
+        if (m_size != 0)
+        {
+            void* data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, file, 0);
+            if (data != MAP_FAILED)
+            {
+                m_data = static_cast<const char*>(data);
+                madvise(data, m_size, MADV_SEQUENTIAL);
+            }
+        }
+        close(file);
+#endif
+        if (m_size != 0 && m_data == nullptr)
+        {
+            throw std::runtime_error("Failed to map file " + fileName);
+        }
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    MappedFile(MappedFile&& other) noexcept
+        : m_data(std::exchange(other.m_data, nullptr))
+        , m_size(std::exchange(other.m_size, 0))
+    {
+    }
+
+    ~MappedFile()
+    {
+        if (m_data == nullptr)
+        {
+            return;
+        }
+#ifdef _WIN32
+        UnmapViewOfFile(m_data);
+#else
+        munmap(const_cast<char*>(m_data), m_size);
+#endif
+    }
+
+    const char* Data() const
+    {
+        return m_data;
+    }
+
+    size_t Size() const
+    {
+        return m_size;
+    }
+
+private:
+    const char* m_data = nullptr;
+    size_t m_size = 0;
+};
@@ -0,0 +1,158 @@
+﻿#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+// Массив для больших таблиц переходов. С hugePages память берётся большими страницами
+// (Windows: MEM_LARGE_PAGES, нужна привилегия SeLockMemoryPrivilege; Linux: madvise(MADV_HUGEPAGE)),
+// если это не удалось - обычными страницами. Элементы инициализируются нулями.
+template <class T>
+class PageArray
+{
+    static_assert(std::is_trivially_copyable_v<T>, "PageArray holds plain table entries");
+
+public:
+    PageArray() = default;
+
+    PageArray(size_t size, bool hugePages)
+        : m_size(size)
+    {
+        if (size == 0)
+        {
+            return;
+        }
+        size_t bytes = size * sizeof(T);
+        if (hugePages)
+        {
+            m_data = static_cast<T*>(AllocateHuge(bytes));
+        }
+        if (m_data == nullptr)
+        {
+            m_data = static_cast<T*>(::operator new(bytes, std::align_val_t(CACHE_LINE)));
+        }
+        std::fill_n(reinterpret_cast<unsigned char*>(m_data), bytes, 0);
+    }
+
+    PageArray(const PageArray&) = delete;
+    PageArray& operator=(const PageArray&) = delete;
+
+    PageArray(PageArray&& other) noexcept
+    {
+        Swap(other);
+    }
+
+    PageArray& operator=(PageArray&& other) noexcept
+    {
+        PageArray(std::move(other)).Swap(*this);
+        return *this;
+    }
+
+    ~PageArray()
+    {
+        if (m_data == nullptr)
+        {
+            return;
+        }
+        if (m_hugeBytes != 0)
+        {
+#ifdef _WIN32
+            VirtualFree(m_data, 0, MEM_RELEASE);
+#else
+            munmap(m_data, m_hugeBytes);
+#endif
+        }
+        else
+        {
+            ::operator delete(m_data, std::align_val_t(CACHE_LINE));
+        }
+    }
+
+    T* Data()
+    {
+        return m_data;
+    }
+
+    const T* Data() const
+    {
+        return m_data;
+    }
+
+    T& operator[](size_t index)
+    {
+        return m_data[index];
+    }
+
+    const T& operator[](size_t index) const
+    {
+        return m_data[index];
+    }
+
+    size_t Size() const
+    {
+        return m_size;
+    }
+
+    bool IsHugePages() const
+    {
+        return m_hugeBytes != 0;
+    }
+
+private:
+    static constexpr size_t CACHE_LINE = 64;
+    static constexpr size_t HUGE_PAGE_SIZE = size_t(2) << 20;
+
+    void Swap(PageArray& other) noexcept
+    {
+        std::swap(m_data, other.m_data);
+        std::swap(m_size, other.m_size);
+        std::swap(m_hugeBytes, other.m_hugeBytes);
+    }
+
+    void* AllocateHuge(size_t bytes)
+    {
+#ifdef _WIN32
+        size_t pageSize = GetLargePageMinimum();
+        if (pageSize == 0)
+        {
+            return nullptr;
+        }
+        size_t rounded = (bytes + pageSize - 1) / pageSize * pageSize;
+        void* memory = VirtualAlloc(nullptr, rounded, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+#else
+        size_t rounded = (bytes + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+        void* memory = mmap(nullptr, rounded, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (memory == MAP_FAILED)
+        {
+            return nullptr;
+        }
+#ifdef MADV_HUGEPAGE
+        if (madvise(memory, rounded, MADV_HUGEPAGE) != 0)
+#endif
+        {
+            munmap(memory, rounded);
+            return nullptr;
+        }
+#endif
+        if (memory != nullptr)
+        {
+            m_hugeBytes = rounded;
+        }
+        return memory;
+    }
+
+    T* m_data = nullptr;
+    size_t m_size = 0;
+    // Размер выделения большими страницами, 0 - обычная память
+    size_t m_hugeBytes = 0;
+};
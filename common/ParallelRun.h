@@ -0,0 +1,101 @@
+﻿#pragma once
+#include <algorithm>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+inline size_t GetHardwareThreadCount()
+{
+    return std::max<size_t>(1, std::thread::hardware_concurrency());
+}
+
+// Делит [0, count) на threadCount частей и выполняет fn(part, begin, end) каждую в своём потоке
+template <class Fn>
+void ParallelFor(size_t count, size_t threadCount, Fn&& fn)
+{
+    if (threadCount <= 1 || count < threadCount)
+    {
+        fn(0, size_t(0), count);
+        return;
+    }
+
+    std::vector<std::thread> threads;
+    size_t chunk = (count + threadCount - 1) / threadCount;
+    for (size_t t = 0; t < threadCount; t++)
+    {
+        size_t begin = std::min(count, t * chunk);
+        size_t end = std::min(count, begin + chunk);
+        threads.emplace_back([&fn, t, begin, end] { fn(t, begin, end); });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+}
+
+// Отображение состояний, в которое кусок входа переводит автомат. Запуски из всех состояний
+// идут одновременно и сливаются, попав в одно состояние; когда живых остаётся не больше одного,
+// остаток куска обрабатывается обычным циклом. Куски считаются параллельно, а затем
+// отображения компонуются по порядку, как в префиксной сумме.
+struct StateMapping
+{
+    // Позиция, с которой все живые запуски идут по одному состоянию
+    size_t convergedAt = 0;
+    // Состояние в позиции convergedAt для каждого начального, -1 - перехода не было
+    std::vector<int> stateAt;
+};
+
+// step(state, symbol) возвращает следующее состояние или -1
+template <class Step>
+StateMapping MapStates(size_t stateCount, const char* input, size_t size, Step&& step)
+{
+    std::vector<int> laneOf(stateCount);
+    std::iota(laneOf.begin(), laneOf.end(), 0);
+    std::vector<int> lanes = laneOf;
+    std::vector<int> slotOf(stateCount, -1);
+    std::vector<int> next, redirect;
+
+    size_t i = 0;
+    for (; i < size && lanes.size() > 1; i++)
+    {
+        next.clear();
+        redirect.resize(lanes.size());
+        for (size_t lane = 0; lane < lanes.size(); lane++)
+        {
+            int target = step(lanes[lane], input[i]);
+            if (target < 0)
+            {
+                redirect[lane] = -1;
+                continue;
+            }
+            if (slotOf[target] < 0)
+            {
+                slotOf[target] = int(next.size());
+                next.push_back(target);
+            }
+            redirect[lane] = slotOf[target];
+        }
+        for (int state : next)
+        {
+            slotOf[state] = -1;
+        }
+        // Без слияний и тупиков номера запусков не меняются
+        if (next.size() < lanes.size())
+        {
+            for (int& lane : laneOf)
+            {
+                lane = lane < 0 ? -1 : redirect[lane];
+            }
+        }
+        lanes.swap(next);
+    }
+
+    StateMapping mapping;
+    mapping.convergedAt = i;
+    mapping.stateAt.resize(stateCount);
+    for (size_t state = 0; state < stateCount; state++)
+    {
+        mapping.stateAt[state] = laneOf[state] < 0 ? -1 : lanes[laneOf[state]];
+    }
+    return mapping;
+}
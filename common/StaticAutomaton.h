@@ -0,0 +1,770 @@
+﻿#pragma once
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+// Автоматы, которые задаются в исходном коде и строятся целиком во время компиляции:
+//
+//     static constexpr auto kController = MinimizeStatic<ParseStaticMoore<R"(header
+//     0;x;a;1
+//     ...)">()>();
+//     static constexpr auto kMatcher = ParseStaticGrammar<"S -> aA | b\nA -> aS | c">();
+//
+// Текст имеет тот же формат, что читают Moore::ReadFromFile, Mealy::ReadFromFile и Grammar
+// (только правая грамматика). Таблицы переходов - constexpr-массивы, начальное состояние 0,
+// состояния пронумерованы в порядке обхода в ширину. Ошибка в тексте - ошибка компиляции.
+
+template <size_t N>
+struct StaticString
+{
+    char data[N]{};
+
+    constexpr StaticString(const char (&text)[N])
+    {
+        std::copy_n(text, N, data);
+    }
+
+    constexpr std::string_view View() const
+    {
+        return { data, N - 1 };
+    }
+};
+
+// Номер символа входного алфавита по байту, -1 для символов вне алфавита
+using StaticSymbolIndex = std::array<short, 256>;
+
+template <size_t StateCount, size_t SymbolCount>
+struct StaticMoore
+{
+    std::array<char, SymbolCount> symbols;
+    StaticSymbolIndex symbolIndex;
+    std::array<char, StateCount> outputs;
+    std::array<std::array<int, SymbolCount>, StateCount> next;
+
+    static constexpr size_t GetStateCount()
+    {
+        return StateCount;
+    }
+
+    constexpr int GetNextState(int state, char input) const
+    {
+        int symbol = symbolIndex[static_cast<unsigned char>(input)];
+        return symbol < 0 ? -1 : next[state][symbol];
+    }
+
+    constexpr char GetOutput(int state) const
+    {
+        return outputs[state];
+    }
+
+    // Пишет выход каждого нового состояния, возвращает последнее состояние или -1
+    template <class OutputIt>
+    constexpr int Run(std::string_view input, OutputIt out) const
+    {
+        int state = 0;
+        for (char symbol : input)
+        {
+            state = GetNextState(state, symbol);
+            if (state < 0)
+            {
+                break;
+            }
+            *out++ = outputs[state];
+        }
+        return state;
+    }
+};
+
+template <size_t StateCount, size_t SymbolCount>
+struct StaticMealy
+{
+    std::array<char, SymbolCount> symbols;
+    StaticSymbolIndex symbolIndex;
+    std::array<std::array<int, SymbolCount>, StateCount> next;
+    std::array<std::array<char, SymbolCount>, StateCount> outputs;
+
+    static constexpr size_t GetStateCount()
+    {
+        return StateCount;
+    }
+
+    constexpr int GetNextState(int state, char input) const
+    {
+        int symbol = symbolIndex[static_cast<unsigned char>(input)];
+        return symbol < 0 ? -1 : next[state][symbol];
+    }
+
+    constexpr char GetOutput(int state, char input) const
+    {
+        return outputs[state][symbolIndex[static_cast<unsigned char>(input)]];
+    }
+
+    // Пишет выход каждого перехода, возвращает последнее состояние или -1
+    template <class OutputIt>
+    constexpr int Run(std::string_view input, OutputIt out) const
+    {
+        int state = 0;
+        for (char symbol : input)
+        {
+            int next = GetNextState(state, symbol);
+            if (next < 0)
+            {
+                return -1;
+            }
+            *out++ = GetOutput(state, symbol);
+            state = next;
+        }
+        return state;
+    }
+};
+
+template <size_t StateCount, size_t SymbolCount>
+struct StaticDfa
+{
+    std::array<char, SymbolCount> symbols;
+    StaticSymbolIndex symbolIndex;
+    std::array<std::array<int, SymbolCount>, StateCount> next;
+    std::array<bool, StateCount> accepting;
+
+    static constexpr size_t GetStateCount()
+    {
+        return StateCount;
+    }
+
+    constexpr int GetNextState(int state, char input) const
+    {
+        int symbol = symbolIndex[static_cast<unsigned char>(input)];
+        return symbol < 0 ? -1 : next[state][symbol];
+    }
+
+    constexpr bool Accepts(std::string_view input) const
+    {
+        int state = 0;
+        for (char symbol : input)
+        {
+            state = GetNextState(state, symbol);
+            if (state < 0)
+            {
+                return false;
+            }
+        }
+        return accepting[state];
+    }
+};
+
+namespace StaticDetails
+{
+    enum class Kind
+    {
+        Moore,
+        Mealy,
+        Dfa,
+    };
+
+    // Промежуточное представление, существует только во время вычисления constexpr
+    struct FlatMachine
+    {
+        Kind kind = Kind::Moore;
+        int stateCount = 0;
+        int startState = 0;
+        std::vector<char> symbols;
+        // next[state * symbols.size() + symbol], -1 - перехода нет
+        std::vector<int> next;
+        std::vector<char> stateOutputs;
+        std::vector<char> outputs;
+        std::vector<char> accepting;
+
+        constexpr int At(int state, size_t symbol) const
+        {
+            return next[state * symbols.size() + symbol];
+        }
+    };
+
+    constexpr bool IsSpace(char c)
+    {
+        return c == ' ' || c == '\t' || c == '\r';
+    }
+
+    constexpr bool IsUpper(char c)
+    {
+        return c >= 'A' && c <= 'Z';
+    }
+
+    constexpr bool IsAlnum(char c)
+    {
+        return IsUpper(c) || (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9');
+    }
+
+    constexpr std::string_view Strip(std::string_view text)
+    {
+        while (!text.empty() && IsSpace(text.front()))
+        {
+            text.remove_prefix(1);
+        }
+        while (!text.empty() && IsSpace(text.back()))
+        {
+            text.remove_suffix(1);
+        }
+        return text;
+    }
+
+    constexpr std::vector<std::string_view> Split(std::string_view text, char separator)
+    {
+        std::vector<std::string_view> parts;
+        size_t start = 0;
+        for (size_t i = 0; i <= text.size(); i++)
+        {
+            if (i == text.size() || text[i] == separator)
+            {
+                parts.push_back(text.substr(start, i - start));
+                start = i + 1;
+            }
+        }
+        return parts;
+    }
+
+    constexpr int ParseInt(std::string_view text)
+    {
+        text = Strip(text);
+        if (text.empty())
+        {
+            throw std::invalid_argument("Expected a state number");
+        }
+        int value = 0;
+        for (char c : text)
+        {
+            if (c < '0' || c > '9')
+            {
+                throw std::invalid_argument("Expected a state number");
+            }
+            value = value * 10 + (c - '0');
+        }
+        return value;
+    }
+
+    constexpr char ParseChar(std::string_view text)
+    {
+        text = Strip(text);
+        if (text.empty())
+        {
+            throw std::invalid_argument("Expected a symbol");
+        }
+        return text[0];
+    }
+
+    template <class T>
+    constexpr int IndexOf(const std::vector<T>& sorted, T value)
+    {
+        auto it = std::lower_bound(sorted.begin(), sorted.end(), value);
+        return it != sorted.end() && *it == value ? int(it - sorted.begin()) : -1;
+    }
+
+    template <class T>
+    constexpr void SortUnique(std::vector<T>& values)
+    {
+        std::sort(values.begin(), values.end());
+        values.erase(std::unique(values.begin(), values.end()), values.end());
+    }
+
+    struct TextRow
+    {
+        int id;
+        char input;
+        int nextId;
+        char output;
+    };
+
+    // Первая строка - заголовок, как в ReadFromFile; переходы в несуществующие состояния отбрасываются
+    constexpr FlatMachine ParseMachineText(std::string_view text, Kind kind)
+    {
+        std::vector<TextRow> rows;
+        auto lines = Split(text, '\n');
+        for (size_t i = 1; i < lines.size(); i++)
+        {
+            if (Strip(lines[i]).empty())
+            {
+                continue;
+            }
+            auto fields = Split(lines[i], ';');
+            if (fields.size() < 4)
+            {
+                throw std::invalid_argument("Expected 4 fields separated by ';'");
+            }
+            rows.push_back(kind == Kind::Moore
+                ? TextRow{ ParseInt(fields[0]), ParseChar(fields[2]), ParseInt(fields[3]), ParseChar(fields[1]) }
+                : TextRow{ ParseInt(fields[0]), ParseChar(fields[1]), ParseInt(fields[2]), ParseChar(fields[3]) });
+        }
+
+        std::vector<int> ids;
+        FlatMachine machine;
+        machine.kind = kind;
+        for (const auto& row : rows)
+        {
+            ids.push_back(row.id);
+            machine.symbols.push_back(row.input);
+        }
+        SortUnique(ids);
+        SortUnique(machine.symbols);
+
+        const size_t symbolCount = machine.symbols.size();
+        machine.stateCount = int(ids.size());
+        machine.startState = std::max(IndexOf(ids, 0), 0);
+        machine.next.assign(ids.size() * symbolCount, -1);
+        machine.outputs.assign(kind == Kind::Mealy ? ids.size() * symbolCount : 0, 0);
+        machine.stateOutputs.assign(kind == Kind::Moore ? ids.size() : 0, 0);
+
+        for (const auto& row : rows)
+        {
+            int state = IndexOf(ids, row.id);
+            size_t cell = state * symbolCount + IndexOf(machine.symbols, row.input);
+            machine.next[cell] = IndexOf(ids, row.nextId);
+            if (kind == Kind::Moore)
+            {
+                machine.stateOutputs[state] = row.output;
+            }
+            else
+            {
+                machine.outputs[cell] = row.output;
+            }
+        }
+
+        return machine;
+    }
+
+    // Правая грамматика: S -> aA | b, начальный нетерминал - из первой строки.
+    // Недетерминированный автомат хранится масками: 26 нетерминалов и заключительное состояние.
+    constexpr FlatMachine ParseRightGrammar(std::string_view text)
+    {
+        const uint32_t finalBit = uint32_t(1) << 26;
+        struct Production
+        {
+            int from;
+            char symbol;
+            uint32_t to;
+        };
+
+        std::vector<Production> productions;
+        int start = -1;
+        for (auto line : Split(text, '\n'))
+        {
+            line = Strip(line);
+            if (line.empty())
+            {
+                continue;
+            }
+            size_t arrow = line.find("->");
+            if (arrow == std::string_view::npos)
+            {
+                throw std::invalid_argument("Invalid grammar format");
+            }
+            if (!IsUpper(line[0]))
+            {
+                throw std::invalid_argument("Non-terminal must be an uppercase letter");
+            }
+            int from = line[0] - 'A';
+            if (start == -1)
+            {
+                start = from;
+            }
+
+            for (auto production : Split(line.substr(arrow + 2), '|'))
+            {
+                production = Strip(production);
+                if (production.empty())
+                {
+                    continue;
+                }
+                if (production.size() == 1 && IsAlnum(production[0]))
+                {
+                    productions.push_back({ from, production[0], finalBit });
+                }
+                else if (production.size() == 2 && IsAlnum(production[0]) && IsUpper(production[1]))
+                {
+                    productions.push_back({ from, production[0], uint32_t(1) << (production[1] - 'A') });
+                }
+                else
+                {
+                    throw std::invalid_argument("Invalid right grammar production");
+                }
+            }
+        }
+        if (start == -1)
+        {
+            throw std::invalid_argument("Grammar has no productions");
+        }
+
+        FlatMachine machine;
+        machine.kind = Kind::Dfa;
+        for (const auto& production : productions)
+        {
+            machine.symbols.push_back(production.symbol);
+        }
+        SortUnique(machine.symbols);
+        const size_t symbolCount = machine.symbols.size();
+
+        // Построение подмножеств
+        std::vector<uint32_t> subsets{ uint32_t(1) << start };
+        for (size_t i = 0; i < subsets.size(); i++)
+        {
+            for (size_t symbol = 0; symbol < symbolCount; symbol++)
+            {
+                uint32_t target = 0;
+                for (const auto& production : productions)
+                {
+                    if (((subsets[i] >> production.from) & 1) && production.symbol == machine.symbols[symbol])
+                    {
+                        target |= production.to;
+                    }
+                }
+                if (target == 0)
+                {
+                    machine.next.push_back(-1);
+                    continue;
+                }
+                auto found = std::find(subsets.begin(), subsets.end(), target);
+                machine.next.push_back(int(found - subsets.begin()));
+                if (found == subsets.end())
+                {
+                    subsets.push_back(target);
+                }
+            }
+            machine.accepting.push_back((subsets[i] & finalBit) != 0);
+        }
+        machine.stateCount = int(subsets.size());
+
+        return machine;
+    }
+
+    // Оставляет достижимые из начального состояния (для DFA ещё и ведущие в заключительное)
+    // и нумерует их в порядке обхода в ширину
+    constexpr FlatMachine Trim(const FlatMachine& machine)
+    {
+        if (machine.stateCount == 0)
+        {
+            return machine;
+        }
+
+        const size_t symbolCount = machine.symbols.size();
+        std::vector<char> useful(machine.stateCount, 1);
+        if (machine.kind == Kind::Dfa)
+        {
+            useful = machine.accepting;
+            for (bool changed = true; changed;)
+            {
+                changed = false;
+                for (int state = 0; state < machine.stateCount; state++)
+                {
+                    for (size_t symbol = 0; symbol < symbolCount && !useful[state]; symbol++)
+                    {
+                        int target = machine.At(state, symbol);
+                        if (target >= 0 && useful[target])
+                        {
+                            useful[state] = 1;
+                            changed = true;
+                        }
+                    }
+                }
+            }
+        }
+
+        std::vector<int> newIds(machine.stateCount, -1);
+        std::vector<int> order{ machine.startState };
+        newIds[machine.startState] = 0;
+        for (size_t i = 0; i < order.size(); i++)
+        {
+            for (size_t symbol = 0; symbol < symbolCount; symbol++)
+            {
+                int target = machine.At(order[i], symbol);
+                if (target >= 0 && useful[target] && newIds[target] == -1)
+                {
+                    newIds[target] = int(order.size());
+                    order.push_back(target);
+                }
+            }
+        }
+
+        FlatMachine trimmed;
+        trimmed.kind = machine.kind;
+        trimmed.stateCount = int(order.size());
+        trimmed.symbols = machine.symbols;
+        for (int state : order)
+        {
+            for (size_t symbol = 0; symbol < symbolCount; symbol++)
+            {
+                int target = machine.At(state, symbol);
+                trimmed.next.push_back(target >= 0 ? newIds[target] : -1);
+                if (machine.kind == Kind::Mealy)
+                {
+                    trimmed.outputs.push_back(machine.outputs[state * symbolCount + symbol]);
+                }
+            }
+            if (machine.kind == Kind::Moore)
+            {
+                trimmed.stateOutputs.push_back(machine.stateOutputs[state]);
+            }
+            if (machine.kind == Kind::Dfa)
+            {
+                trimmed.accepting.push_back(machine.accepting[state]);
+            }
+        }
+
+        return trimmed;
+    }
+
+    // Номера классов по равенству сигнатур
+    constexpr int AssignClasses(const std::vector<std::vector<int>>& signatures, std::vector<int>& classOf)
+    {
+        std::vector<int> order(signatures.size());
+        for (size_t i = 0; i < order.size(); i++)
+        {
+            order[i] = int(i);
+        }
+        std::sort(order.begin(), order.end(), [&](int a, int b) {
+            return signatures[a] < signatures[b];
+        });
+
+        int classCount = 0;
+        for (size_t i = 0; i < order.size(); i++)
+        {
+            if (i > 0 && signatures[order[i]] != signatures[order[i - 1]])
+            {
+                classCount++;
+            }
+            classOf[order[i]] = classCount;
+        }
+        return order.empty() ? 0 : classCount + 1;
+    }
+
+    constexpr FlatMachine Minimize(const FlatMachine& source)
+    {
+        FlatMachine machine = Trim(source);
+        const size_t symbolCount = machine.symbols.size();
+
+        std::vector<std::vector<int>> signatures(machine.stateCount);
+        for (int state = 0; state < machine.stateCount; state++)
+        {
+            if (machine.kind == Kind::Moore)
+            {
+                signatures[state].push_back(static_cast<unsigned char>(machine.stateOutputs[state]));
+            }
+            else if (machine.kind == Kind::Dfa)
+            {
+                signatures[state].push_back(machine.accepting[state]);
+            }
+            else
+            {
+                for (size_t symbol = 0; symbol < symbolCount; symbol++)
+                {
+                    signatures[state].push_back(machine.At(state, symbol) < 0 ? -1 : static_cast<unsigned char>(machine.outputs[state * symbolCount + symbol]));
+                }
+            }
+        }
+
+        std::vector<int> classOf(machine.stateCount);
+        int classCount = AssignClasses(signatures, classOf);
+        while (true)
+        {
+            for (int state = 0; state < machine.stateCount; state++)
+            {
+                signatures[state] = { classOf[state] };
+                for (size_t symbol = 0; symbol < symbolCount; symbol++)
+                {
+                    int target = machine.At(state, symbol);
+                    signatures[state].push_back(target < 0 ? -1 : classOf[target]);
+                }
+            }
+            int newClassCount = AssignClasses(signatures, classOf);
+            if (newClassCount == classCount)
+            {
+                break;
+            }
+            classCount = newClassCount;
+        }
+
+        // Представитель класса - первое состояние в нём
+        std::vector<int> representative(classCount, -1);
+        for (int state = machine.stateCount - 1; state >= 0; state--)
+        {
+            representative[classOf[state]] = state;
+        }
+
+        FlatMachine minimized;
+        minimized.kind = machine.kind;
+        minimized.stateCount = classCount;
+        minimized.startState = classOf[machine.startState];
+        minimized.symbols = machine.symbols;
+        for (int state : representative)
+        {
+            for (size_t symbol = 0; symbol < symbolCount; symbol++)
+            {
+                int target = machine.At(state, symbol);
+                minimized.next.push_back(target < 0 ? -1 : classOf[target]);
+                if (machine.kind == Kind::Mealy)
+                {
+                    minimized.outputs.push_back(machine.outputs[state * symbolCount + symbol]);
+                }
+            }
+            if (machine.kind == Kind::Moore)
+            {
+                minimized.stateOutputs.push_back(machine.stateOutputs[state]);
+            }
+            if (machine.kind == Kind::Dfa)
+            {
+                minimized.accepting.push_back(machine.accepting[state]);
+            }
+        }
+
+        return Trim(minimized);
+    }
+
+    template <size_t StateCount, size_t SymbolCount, class Static>
+    constexpr void FillTables(const FlatMachine& machine, Static& result)
+    {
+        result.symbolIndex.fill(-1);
+        for (size_t symbol = 0; symbol < SymbolCount; symbol++)
+        {
+            result.symbols[symbol] = machine.symbols[symbol];
+            result.symbolIndex[static_cast<unsigned char>(machine.symbols[symbol])] = short(symbol);
+        }
+        for (size_t state = 0; state < StateCount; state++)
+        {
+            for (size_t symbol = 0; symbol < SymbolCount; symbol++)
+            {
+                result.next[state][symbol] = machine.At(int(state), symbol);
+            }
+        }
+    }
+
+    template <class Static>
+    constexpr FlatMachine ToFlat(const Static& machine, Kind kind)
+    {
+        FlatMachine flat;
+        flat.kind = kind;
+        flat.stateCount = int(machine.next.size());
+        flat.symbols.assign(machine.symbols.begin(), machine.symbols.end());
+        for (const auto& row : machine.next)
+        {
+            flat.next.insert(flat.next.end(), row.begin(), row.end());
+        }
+        return flat;
+    }
+
+    template <size_t StateCount, size_t SymbolCount>
+    constexpr FlatMachine ToFlat(const StaticMoore<StateCount, SymbolCount>& machine)
+    {
+        FlatMachine flat = ToFlat(machine, Kind::Moore);
+        flat.stateOutputs.assign(machine.outputs.begin(), machine.outputs.end());
+        return flat;
+    }
+
+    template <size_t StateCount, size_t SymbolCount>
+    constexpr FlatMachine ToFlat(const StaticMealy<StateCount, SymbolCount>& machine)
+    {
+        FlatMachine flat = ToFlat(machine, Kind::Mealy);
+        for (const auto& row : machine.outputs)
+        {
+            flat.outputs.insert(flat.outputs.end(), row.begin(), row.end());
+        }
+        return flat;
+    }
+
+    template <size_t StateCount, size_t SymbolCount>
+    constexpr FlatMachine ToFlat(const StaticDfa<StateCount, SymbolCount>& machine)
+    {
+        FlatMachine flat = ToFlat(machine, Kind::Dfa);
+        flat.accepting.assign(machine.accepting.begin(), machine.accepting.end());
+        return flat;
+    }
+
+    // Размеры таблиц известны только после построения, поэтому Build вызывается
+    // отдельно для каждого размера и для заполнения: промежуточные векторы не
+    // переживают вычисление константы.
+    template <FlatMachine (*Build)()>
+    constexpr auto Materialize()
+    {
+        constexpr size_t stateCount = size_t(Build().stateCount);
+        constexpr size_t symbolCount = Build().symbols.size();
+        constexpr Kind kind = Build().kind;
+
+        const FlatMachine machine = Build();
+        if constexpr (kind == Kind::Moore)
+        {
+            StaticMoore<stateCount, symbolCount> result{};
+            FillTables<stateCount, symbolCount>(machine, result);
+            std::copy_n(machine.stateOutputs.begin(), stateCount, result.outputs.begin());
+            return result;
+        }
+        else if constexpr (kind == Kind::Mealy)
+        {
+            StaticMealy<stateCount, symbolCount> result{};
+            FillTables<stateCount, symbolCount>(machine, result);
+            for (size_t state = 0; state < stateCount; state++)
+            {
+                std::copy_n(machine.outputs.begin() + state * symbolCount, symbolCount, result.outputs[state].begin());
+            }
+            return result;
+        }
+        else
+        {
+            StaticDfa<stateCount, symbolCount> result{};
+            FillTables<stateCount, symbolCount>(machine, result);
+            std::copy_n(machine.accepting.begin(), stateCount, result.accepting.begin());
+            return result;
+        }
+    }
+
+    template <StaticString Text>
+    constexpr FlatMachine BuildMoore()
+    {
+        return Trim(ParseMachineText(Text.View(), Kind::Moore));
+    }
+
+    template <StaticString Text>
+    constexpr FlatMachine BuildMealy()
+    {
+        return Trim(ParseMachineText(Text.View(), Kind::Mealy));
+    }
+
+    template <StaticString Text>
+    constexpr FlatMachine BuildGrammarDfa()
+    {
+        return Minimize(ParseRightGrammar(Text.View()));
+    }
+
+    template <auto Machine>
+    constexpr FlatMachine BuildMinimized()
+    {
+        return Minimize(ToFlat(Machine));
+    }
+}
+
+// Автомат Мура из текста в формате Moore::ReadFromFile: заголовок, затем "id;output;input;next"
+template <StaticString Text>
+constexpr auto ParseStaticMoore()
+{
+    return StaticDetails::Materialize<&StaticDetails::BuildMoore<Text>>();
+}
+
+// Автомат Мили из текста в формате Mealy::ReadFromFile: заголовок, затем "id;input;next;output"
+template <StaticString Text>
+constexpr auto ParseStaticMealy()
+{
+    return StaticDetails::Materialize<&StaticDetails::BuildMealy<Text>>();
+}
+
+// Минимальный DFA правой грамматики
+template <StaticString Text>
+constexpr auto ParseStaticGrammar()
+{
+    return StaticDetails::Materialize<&StaticDetails::BuildGrammarDfa<Text>>();
+}
+
+// Минимизация StaticMoore, StaticMealy или StaticDfa
+template <auto Machine>
+constexpr auto MinimizeStatic()
+{
+    return StaticDetails::Materialize<&StaticDetails::BuildMinimized<Machine>>();
+}
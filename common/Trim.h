@@ -0,0 +1,335 @@
+﻿#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "ParallelRun.h"
+
+// Граф переходов в формате CSR: рёбра вершины v лежат в targets[offsets[v]..offsets[v + 1])
+struct CsrGraph
+{
+    std::vector<uint32_t> offsets;
+    std::vector<uint32_t> targets;
+
+    size_t GetVertexCount() const
+    {
+        return offsets.empty() ? 0 : offsets.size() - 1;
+    }
+};
+
+class Bitset
+{
+public:
+    explicit Bitset(size_t size = 0)
+        : m_size(size)
+        , m_words((size + 63) / 64, 0)
+    {
+    }
+
+    bool Test(size_t index) const
+    {
+        return (m_words[index / 64] >> (index % 64)) & 1;
+    }
+
+    void Set(size_t index)
+    {
+        m_words[index / 64] |= uint64_t(1) << (index % 64);
+    }
+
+    size_t Size() const
+    {
+        return m_size;
+    }
+
+    size_t Count() const
+    {
+        size_t count = 0;
+        for (uint64_t word : m_words)
+        {
+            for (; word != 0; word &= word - 1)
+            {
+                count++;
+            }
+        }
+        return count;
+    }
+
+    Bitset& operator&=(const Bitset& other)
+    {
+        for (size_t i = 0; i < m_words.size(); i++)
+        {
+            m_words[i] &= other.m_words[i];
+        }
+        return *this;
+    }
+
+    std::vector<uint64_t>& Words()
+    {
+        return m_words;
+    }
+
+    const std::vector<uint64_t>& Words() const
+    {
+        return m_words;
+    }
+
+private:
+    size_t m_size;
+    std::vector<uint64_t> m_words;
+};
+
+inline CsrGraph BuildCsr(size_t vertexCount, const std::vector<std::pair<uint32_t, uint32_t>>& edges)
+{
+    CsrGraph graph;
+    graph.offsets.assign(vertexCount + 1, 0);
+    for (const auto& [from, to] : edges)
+    {
+        graph.offsets[from + 1]++;
+    }
+    for (size_t v = 0; v < vertexCount; v++)
+    {
+        graph.offsets[v + 1] += graph.offsets[v];
+    }
+
+    graph.targets.resize(edges.size());
+    std::vector<uint32_t> position(graph.offsets.begin(), graph.offsets.end() - 1);
+    for (const auto& [from, to] : edges)
+    {
+        graph.targets[position[from]++] = to;
+    }
+
+    return graph;
+}
+
+inline CsrGraph Transpose(const CsrGraph& graph)
+{
+    std::vector<std::pair<uint32_t, uint32_t>> edges;
+    edges.reserve(graph.targets.size());
+    for (uint32_t v = 0; v < graph.GetVertexCount(); v++)
+    {
+        for (uint32_t i = graph.offsets[v]; i < graph.offsets[v + 1]; i++)
+        {
+            edges.emplace_back(graph.targets[i], v);
+        }
+    }
+    return BuildCsr(graph.GetVertexCount(), edges);
+}
+
+namespace TrimDetails
+{
+    // Графы меньше этого размера обходятся в одном потоке
+    const size_t PARALLEL_THRESHOLD = 1 << 16;
+    // Параметры переключения направления обхода (Beamer et al.)
+    const size_t TOP_DOWN_TO_BOTTOM_UP = 14;
+    const size_t BOTTOM_UP_TO_TOP_DOWN = 24;
+
+    inline bool TrySet(std::atomic<uint64_t>* words, uint32_t v)
+    {
+        uint64_t mask = uint64_t(1) << (v % 64);
+        if (words[v / 64].load(std::memory_order_relaxed) & mask)
+        {
+            return false;
+        }
+        return (words[v / 64].fetch_or(mask, std::memory_order_relaxed) & mask) == 0;
+    }
+}
+
+// Множество вершин, достижимых из sources. reverse - транспонированный graph,
+// нужен для шагов "снизу вверх" на больших фронтах.
+inline Bitset FindReachable(const CsrGraph& graph, const CsrGraph& reverse, const std::vector<uint32_t>& sources)
+{
+    using namespace TrimDetails;
+
+    const size_t n = graph.GetVertexCount();
+    const size_t wordCount = (n + 63) / 64;
+    const size_t threadCount = n < PARALLEL_THRESHOLD
+        ? 1
+        : GetHardwareThreadCount();
+
+    auto visited = std::make_unique<std::atomic<uint64_t>[]>(wordCount);
+    for (size_t i = 0; i < wordCount; i++)
+    {
+        visited[i].store(0, std::memory_order_relaxed);
+    }
+
+    std::vector<uint32_t> frontier;
+    for (uint32_t source : sources)
+    {
+        if (source < n && TrySet(visited.get(), source))
+        {
+            frontier.push_back(source);
+        }
+    }
+
+    size_t uncheckedEdges = graph.targets.size();
+    std::vector<std::vector<uint32_t>> nextParts(threadCount);
+    Bitset frontierBits(n), nextBits(n);
+
+    while (!frontier.empty())
+    {
+        size_t frontierEdges = 0;
+        for (uint32_t v : frontier)
+        {
+            frontierEdges += graph.offsets[v + 1] - graph.offsets[v];
+        }
+        uncheckedEdges -= std::min(uncheckedEdges, frontierEdges);
+
+        bool bottomUp = threadCount > 1
+            && frontierEdges * TOP_DOWN_TO_BOTTOM_UP > uncheckedEdges
+            && frontier.size() * BOTTOM_UP_TO_TOP_DOWN > n;
+
+        if (!bottomUp)
+        {
+            ParallelFor(frontier.size(), threadCount, [&](size_t t, size_t begin, size_t end) {
+                auto& next = nextParts[t];
+                next.clear();
+                for (size_t i = begin; i < end; i++)
+                {
+                    uint32_t v = frontier[i];
+                    for (uint32_t e = graph.offsets[v]; e < graph.offsets[v + 1]; e++)
+                    {
+                        if (TrySet(visited.get(), graph.targets[e]))
+                        {
+                            next.push_back(graph.targets[e]);
+                        }
+                    }
+                }
+            });
+        }
+        else
+        {
+            std::fill(frontierBits.Words().begin(), frontierBits.Words().end(), 0);
+            for (uint32_t v : frontier)
+            {
+                frontierBits.Set(v);
+            }
+
+            // Каждый поток владеет своим диапазоном слов, поэтому запись без конфликтов
+            ParallelFor(wordCount, threadCount, [&](size_t t, size_t begin, size_t end) {
+                auto& next = nextParts[t];
+                next.clear();
+                for (size_t w = begin; w < end; w++)
+                {
+                    uint64_t word = visited[w].load(std::memory_order_relaxed);
+                    uint64_t added = 0;
+                    for (size_t bit = 0; bit < 64 && w * 64 + bit < n; bit++)
+                    {
+                        if (word >> bit & 1)
+                        {
+                            continue;
+                        }
+                        uint32_t v = uint32_t(w * 64 + bit);
+                        for (uint32_t e = reverse.offsets[v]; e < reverse.offsets[v + 1]; e++)
+                        {
+                            if (frontierBits.Test(reverse.targets[e]))
+                            {
+                                added |= uint64_t(1) << bit;
+                                next.push_back(v);
+                                break;
+                            }
+                        }
+                    }
+                    visited[w].store(word | added, std::memory_order_relaxed);
+                }
+            });
+        }
+
+        frontier.clear();
+        for (auto& part : nextParts)
+        {
+            frontier.insert(frontier.end(), part.begin(), part.end());
+        }
+    }
+
+    Bitset result(n);
+    for (size_t i = 0; i < wordCount; i++)
+    {
+        result.Words()[i] = visited[i].load(std::memory_order_relaxed);
+    }
+    return result;
+}
+
+inline Bitset FindReachable(const CsrGraph& graph, const std::vector<uint32_t>& sources)
+{
+    if (graph.GetVertexCount() < TrimDetails::PARALLEL_THRESHOLD)
+    {
+        return FindReachable(graph, graph, sources);
+    }
+    return FindReachable(graph, Transpose(graph), sources);
+}
+
+// Вершины распознавателя, достижимые из начальных и ведущие в заключительные.
+// Без заключительных полезных вершин нет; у преобразователей достаточно FindReachable.
+inline Bitset FindUsefulStates(const CsrGraph& graph, const std::vector<uint32_t>& initial, const std::vector<uint32_t>& accepting)
+{
+    CsrGraph reverse = Transpose(graph);
+    Bitset useful = FindReachable(graph, reverse, initial);
+    useful &= FindReachable(reverse, graph, accepting);
+    return useful;
+}
+
+// Полезные состояния распознавателя с произвольными номерами состояний.
+// Вершины нумеруются в порядке states, затем добавляются начальное и заключительные,
+// которых в states нет (например, заключительное без строки переходов).
+template <class State>
+class UsefulStates
+{
+public:
+    // forEachTarget(state, visit) вызывает visit(target) для каждого перехода из state
+    template <class ForEachTarget>
+    UsefulStates(const std::vector<State>& states, const State& initState, const std::vector<State>& finalStates,
+        ForEachTarget&& forEachTarget)
+        : m_initState(initState)
+    {
+        m_index.reserve(states.size() + finalStates.size() + 1);
+        for (const State& state : states)
+        {
+            AddState(state);
+        }
+        AddState(initState);
+        for (const State& finalState : finalStates)
+        {
+            AddState(finalState);
+        }
+
+        std::vector<std::pair<uint32_t, uint32_t>> edges;
+        for (const State& state : states)
+        {
+            const uint32_t from = m_index.find(state)->second;
+            forEachTarget(state, [this, from, &edges](const State& target) {
+                auto it = m_index.find(target);
+                if (it != m_index.end())
+                {
+                    edges.emplace_back(from, it->second);
+                }
+            });
+        }
+
+        std::vector<uint32_t> accepting;
+        for (const State& finalState : finalStates)
+        {
+            accepting.push_back(m_index.find(finalState)->second);
+        }
+        m_useful = FindUsefulStates(BuildCsr(m_index.size(), edges), { m_index.find(initState)->second }, accepting);
+    }
+
+    // Начальное состояние остаётся всегда, неизвестные состояния не удаляются
+    bool IsRemoved(const State& state) const
+    {
+        auto it = m_index.find(state);
+        return it != m_index.end() && !m_useful.Test(it->second) && !(state == m_initState);
+    }
+
+private:
+    void AddState(const State& state)
+    {
+        m_index.emplace(state, uint32_t(m_index.size()));
+    }
+
+    State m_initState;
+    std::unordered_map<State, uint32_t> m_index;
+    Bitset m_useful;
+};
@@ -0,0 +1,115 @@
+﻿#include "Machine.h"
+#include <map>
+
+namespace
+{
+    using namespace std;
+
+    const int START_STATE_ID = 0;
+
+    // Нумерация в порядке обхода в ширину от начального состояния,
+    // переходы перебираются по возрастанию входного символа.
+    template <class State>
+    vector<State> CanonicalizeMachine(const vector<State>& machine)
+    {
+        map<int, size_t> indexOfId;
+        for (size_t i = 0; i < machine.size(); i++)
+        {
+            indexOfId[machine[i].id] = i;
+        }
+        if (machine.empty())
+        {
+            return {};
+        }
+
+        size_t start = indexOfId.count(START_STATE_ID) ? indexOfId[START_STATE_ID] : 0;
+        vector<int> newIds(machine.size(), -1);
+        vector<size_t> order{ start };
+        newIds[start] = 0;
+
+        for (size_t i = 0; i < order.size(); i++)
+        {
+            for (auto [input, transition] : machine[order[i]].transitions)
+            {
+                auto it = indexOfId.find(TargetOf(transition));
+                if (it != indexOfId.end() && newIds[it->second] == -1)
+                {
+                    newIds[it->second] = int(order.size());
+                    order.push_back(it->second);
+                }
+            }
+        }
+
+        vector<State> canonical;
+        canonical.reserve(order.size());
+        for (size_t index : order)
+        {
+            State state = machine[index];
+            state.id = newIds[index];
+            for (auto it = state.transitions.begin(); it != state.transitions.end();)
+            {
+                auto target = indexOfId.find(TargetOf(it->second));
+                if (target == indexOfId.end())
+                {
+                    it = state.transitions.erase(it);
+                    continue;
+                }
+                TargetOf(it->second) = newIds[target->second];
+                ++it;
+            }
+            canonical.push_back(move(state));
+        }
+
+        return canonical;
+    }
+}
+
+Moore::Machine Moore::Canonicalize(const Machine& machine)
+{
+    return CanonicalizeMachine(machine);
+}
+
+Hash128 Moore::GetContentHash(const Machine& machine)
+{
+    Machine canonical = Canonicalize(machine);
+
+    vector<uint8_t> bytes{ 'M' };
+    AppendUint32(bytes, uint32_t(canonical.size()));
+    for (const auto& state : canonical)
+    {
+        bytes.push_back(uint8_t(state.output));
+        AppendUint32(bytes, uint32_t(state.transitions.size()));
+        for (const auto& [input, nextState] : state.transitions)
+        {
+            bytes.push_back(uint8_t(input));
+            AppendUint32(bytes, uint32_t(nextState));
+        }
+    }
+
+    return HashBytes(bytes);
+}
+
+Mealy::Machine Mealy::Canonicalize(const Machine& machine)
+{
+    return CanonicalizeMachine(machine);
+}
+
+Hash128 Mealy::GetContentHash(const Machine& machine)
+{
+    Machine canonical = Canonicalize(machine);
+
+    vector<uint8_t> bytes{ 'L' };
+    AppendUint32(bytes, uint32_t(canonical.size()));
+    for (const auto& state : canonical)
+    {
+        AppendUint32(bytes, uint32_t(state.transitions.size()));
+        for (const auto& [input, transition] : state.transitions)
+        {
+            bytes.push_back(uint8_t(input));
+            AppendUint32(bytes, uint32_t(transition.first));
+            bytes.push_back(uint8_t(transition.second));
+        }
+    }
+
+    return HashBytes(bytes);
+}
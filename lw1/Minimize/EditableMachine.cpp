@@ -0,0 +1,564 @@
+﻿#include "EditableMachine.h"
+#include <algorithm>
+#include <stdexcept>
+
+using namespace std;
+
+EditableMachine::EditableMachine(const Moore::Machine& machine)
+    : m_isMoore(true)
+{
+    int maxId = -1;
+    for (const auto& state : machine)
+    {
+        maxId = max(maxId, state.id);
+        for (const auto& [input, nextState] : state.transitions)
+        {
+            maxId = max(maxId, nextState);
+        }
+    }
+    while (int(m_states.size()) <= maxId)
+    {
+        AddState();
+    }
+    for (const auto& state : machine)
+    {
+        SetStateOutput(state.id, state.output);
+        for (const auto& [input, nextState] : state.transitions)
+        {
+            SetTransition(state.id, input, nextState);
+        }
+    }
+    Reminimize();
+}
+
+EditableMachine::EditableMachine(const Mealy::Machine& machine)
+    : m_isMoore(false)
+{
+    int maxId = -1;
+    for (const auto& state : machine)
+    {
+        maxId = max(maxId, state.id);
+        for (const auto& [input, transition] : state.transitions)
+        {
+            maxId = max(maxId, transition.first);
+        }
+    }
+    while (int(m_states.size()) <= maxId)
+    {
+        AddState();
+    }
+    for (const auto& state : machine)
+    {
+        for (const auto& [input, transition] : state.transitions)
+        {
+            SetTransition(state.id, input, transition.first, transition.second);
+        }
+    }
+    Reminimize();
+}
+
+int EditableMachine::AddState(char output)
+{
+    int state = int(m_states.size());
+    m_states.emplace_back();
+    m_states.back().output = output;
+    m_predecessors.emplace_back();
+    m_block.push_back(-1);
+    m_dirty.insert(state);
+    return state;
+}
+
+void EditableMachine::SetTransition(int state, char input, int nextState, char output)
+{
+    CheckState(state);
+    CheckState(nextState);
+
+    auto& transitions = m_states[state].transitions;
+    auto it = transitions.find(input);
+    if (it != transitions.end())
+    {
+        RemoveEdge(state, it->second.target);
+    }
+    transitions[input] = { nextState, m_isMoore ? char(0) : output };
+    AddEdge(state, nextState);
+    m_dirty.insert(state);
+}
+
+void EditableMachine::RemoveTransition(int state, char input)
+{
+    CheckState(state);
+
+    auto& transitions = m_states[state].transitions;
+    auto it = transitions.find(input);
+    if (it == transitions.end())
+    {
+        return;
+    }
+    RemoveEdge(state, it->second.target);
+    transitions.erase(it);
+    m_dirty.insert(state);
+}
+
+void EditableMachine::SetStateOutput(int state, char output)
+{
+    CheckState(state);
+    if (!m_isMoore)
+    {
+        throw logic_error("Mealy machine states have no output");
+    }
+    m_states[state].output = output;
+    m_dirty.insert(state);
+}
+
+void EditableMachine::Reminimize()
+{
+    if (m_dirty.empty())
+    {
+        return;
+    }
+
+    // Без прежних классов разбиение по локальным ключам самое грубое, и уточнение
+    // сразу даёт минимальное разбиение
+    const bool hadBlocks = m_members.size() > m_freeBlocks.size();
+
+    map<string, int> newStateBlocks;
+    for (int state : m_dirty)
+    {
+        if (m_block[state] == -1)
+        {
+            string key = GetLocalKey(state);
+            auto it = newStateBlocks.find(key);
+            if (it == newStateBlocks.end())
+            {
+                it = newStateBlocks.emplace(key, CreateBlock(key)).first;
+            }
+            m_block[state] = it->second;
+            m_members[it->second].insert(state);
+        }
+    }
+
+    unordered_set<int> changedBlocks;
+    for (int state : m_dirty)
+    {
+        changedBlocks.insert(m_block[state]);
+        Touch(state);
+    }
+    m_dirty.clear();
+
+    SplitTouchedBlocks(changedBlocks);
+    if (hadBlocks)
+    {
+        MergeEquivalentBlocks(changedBlocks);
+    }
+}
+
+// Уточнение до устойчивого разбиения. Сигнатура состояния меняется, только если его правили
+// или его преемник перешёл в другой класс; остальные состояния класса сохраняют общую
+// сигнатуру, поэтому разбор класса стоит столько, сколько в нём затронутых состояний.
+void EditableMachine::SplitTouchedBlocks(unordered_set<int>& changedBlocks)
+{
+    while (!m_splitQueue.empty())
+    {
+        const int block = m_splitQueue.back();
+        m_splitQueue.pop_back();
+        const unordered_set<int> touched = move(m_touched[block]);
+        m_touched.erase(block);
+
+        map<Signature, vector<int>> groups;
+        for (int state : touched)
+        {
+            groups[GetSignature(state)].push_back(state);
+        }
+
+        // В классе остаются состояния с сигнатурой нетронутых, а если тронуты все - самая большая группа
+        auto stay = groups.end();
+        if (touched.size() < m_members[block].size())
+        {
+            for (int state : m_members[block])
+            {
+                if (!touched.count(state))
+                {
+                    stay = groups.find(GetSignature(state));
+                    break;
+                }
+            }
+        }
+        else
+        {
+            stay = max_element(groups.begin(), groups.end(), [](const auto& a, const auto& b) {
+                return a.second.size() < b.second.size();
+            });
+            SetBlockKey(block, stay->first.first);
+        }
+
+        // Предшественников трогаем после переноса всех групп, иначе отметка останется в старом классе
+        vector<int> moved;
+        for (auto it = groups.begin(); it != groups.end(); ++it)
+        {
+            if (it == stay)
+            {
+                continue;
+            }
+            const int newBlock = CreateBlock(it->first.first);
+            changedBlocks.insert(block);
+            changedBlocks.insert(newBlock);
+            for (int state : it->second)
+            {
+                m_members[block].erase(state);
+                m_block[state] = newBlock;
+                m_members[newBlock].insert(state);
+                moved.push_back(state);
+            }
+        }
+        for (int state : moved)
+        {
+            for (const auto& [predecessor, count] : m_predecessors[state])
+            {
+                Touch(predecessor);
+            }
+        }
+    }
+}
+
+// Уточнение не объединяет классы, а правка могла сделать класс эквивалентным другому.
+// Если классы стали эквивалентны, их общая бисимуляция проходит через изменённый класс,
+// эквивалентный другому, поэтому изменённые классы сравниваются с классами того же ключа.
+// После объединения меняются сигнатуры предшественников, их классы проверяются следом.
+void EditableMachine::MergeEquivalentBlocks(const unordered_set<int>& changedBlocks)
+{
+    vector<int> queue(changedBlocks.begin(), changedBlocks.end());
+    while (!queue.empty())
+    {
+        const int block = queue.back();
+        queue.pop_back();
+        if (m_members[block].empty())
+        {
+            continue;
+        }
+
+        // Класс может стать эквивалентным сразу нескольким классам, проверяются все кандидаты
+        const auto& sameKey = m_blocksByKey.at(m_blockKeys[block]);
+        const vector<int> candidates(sameKey.begin(), sameKey.end());
+        for (int candidate : candidates)
+        {
+            if (m_members[block].empty())
+            {
+                break;
+            }
+            if (candidate == block || m_members[candidate].empty())
+            {
+                continue;
+            }
+            for (auto& blocks : FindEquivalentBlocks(block, candidate))
+            {
+                MergeBlocks(blocks, queue);
+            }
+        }
+    }
+}
+
+// Состояния переходят в самый большой класс группы; он и классы предшественников
+// перенесённых состояний проверяются снова
+void EditableMachine::MergeBlocks(const vector<int>& blocks, vector<int>& queue)
+{
+    const int target = *max_element(blocks.begin(), blocks.end(), [this](int a, int b) {
+        return m_members[a].size() < m_members[b].size();
+    });
+    queue.push_back(target);
+    for (int merged : blocks)
+    {
+        if (merged == target)
+        {
+            continue;
+        }
+        vector<int> states(m_members[merged].begin(), m_members[merged].end());
+        for (int state : states)
+        {
+            RemoveFromBlock(state);
+            m_block[state] = target;
+            m_members[target].insert(state);
+        }
+        for (int state : states)
+        {
+            for (const auto& [predecessor, count] : m_predecessors[state])
+            {
+                queue.push_back(m_block[predecessor]);
+            }
+        }
+    }
+}
+
+// Проверка эквивалентности двух классов устойчивого разбиения обходом пар (Хопкрофт - Карп).
+// Возвращает группы классов, которые надо объединить, или пусто, если классы различимы.
+vector<vector<int>> EditableMachine::FindEquivalentBlocks(int first, int second) const
+{
+    // Большинство кандидатов различается уже на следующем шаге, их отсеиваем без обхода
+    const auto& firstTransitions = m_states[*m_members[first].begin()].transitions;
+    const auto& secondTransitions = m_states[*m_members[second].begin()].transitions;
+    for (auto itA = firstTransitions.begin(), itB = secondTransitions.begin(); itA != firstTransitions.end(); ++itA, ++itB)
+    {
+        if (m_blockKeys[m_block[itA->second.target]] != m_blockKeys[m_block[itB->second.target]])
+        {
+            return {};
+        }
+    }
+
+    unordered_map<int, int> parent;
+    auto find = [&parent](int block) {
+        auto it = parent.find(block);
+        while (it != parent.end() && it->second != block)
+        {
+            block = it->second;
+            it = parent.find(block);
+        }
+        return block;
+    };
+
+    vector<pair<int, int>> pairs{ { first, second } };
+    while (!pairs.empty())
+    {
+        auto [a, b] = pairs.back();
+        pairs.pop_back();
+        const int rootA = find(a);
+        const int rootB = find(b);
+        if (rootA == rootB)
+        {
+            continue;
+        }
+        // Одинаковый ключ - те же выходы и входные символы
+        if (m_blockKeys[a] != m_blockKeys[b])
+        {
+            return {};
+        }
+        parent[rootA] = rootB;
+        parent.emplace(rootB, rootB);
+
+        const auto& transitionsA = m_states[*m_members[a].begin()].transitions;
+        const auto& transitionsB = m_states[*m_members[b].begin()].transitions;
+        for (auto itA = transitionsA.begin(), itB = transitionsB.begin(); itA != transitionsA.end(); ++itA, ++itB)
+        {
+            pairs.emplace_back(m_block[itA->second.target], m_block[itB->second.target]);
+        }
+    }
+
+    map<int, vector<int>> classes;
+    for (const auto& [block, up] : parent)
+    {
+        classes[find(block)].push_back(block);
+    }
+    vector<vector<int>> result;
+    for (auto& [root, blocks] : classes)
+    {
+        result.push_back(move(blocks));
+    }
+    return result;
+}
+
+int EditableMachine::GetBlock(int state)
+{
+    CheckState(state);
+    Reminimize();
+    return m_block[state];
+}
+
+size_t EditableMachine::GetBlockCount()
+{
+    Reminimize();
+    return m_members.size() - m_freeBlocks.size();
+}
+
+size_t EditableMachine::GetStateCount() const
+{
+    return m_states.size();
+}
+
+Moore::Machine EditableMachine::GetMinimizedMoore()
+{
+    if (!m_isMoore)
+    {
+        throw logic_error("Machine is not a Moore machine");
+    }
+
+    vector<int> order = GetBlockOrder();
+    vector<int> blockIndex(m_members.size(), -1);
+    for (size_t i = 0; i < order.size(); i++)
+    {
+        blockIndex[order[i]] = int(i);
+    }
+
+    Moore::Machine minimized;
+    for (size_t i = 0; i < order.size(); i++)
+    {
+        const State& representative = m_states[*m_members[order[i]].begin()];
+        Moore::State state;
+        state.id = int(i);
+        state.output = representative.output;
+        for (const auto& [input, transition] : representative.transitions)
+        {
+            state.transitions[input] = blockIndex[m_block[transition.target]];
+        }
+        minimized.push_back(state);
+    }
+
+    // Как и Minimize, без недостижимых классов
+    return Moore::Canonicalize(minimized);
+}
+
+Mealy::Machine EditableMachine::GetMinimizedMealy()
+{
+    if (m_isMoore)
+    {
+        throw logic_error("Machine is not a Mealy machine");
+    }
+
+    vector<int> order = GetBlockOrder();
+    vector<int> blockIndex(m_members.size(), -1);
+    for (size_t i = 0; i < order.size(); i++)
+    {
+        blockIndex[order[i]] = int(i);
+    }
+
+    Mealy::Machine minimized;
+    for (size_t i = 0; i < order.size(); i++)
+    {
+        const State& representative = m_states[*m_members[order[i]].begin()];
+        Mealy::State state;
+        state.id = int(i);
+        for (const auto& [input, transition] : representative.transitions)
+        {
+            state.transitions[input] = { blockIndex[m_block[transition.target]], transition.output };
+        }
+        minimized.push_back(state);
+    }
+
+    return Mealy::Canonicalize(minimized);
+}
+
+void EditableMachine::CheckState(int state) const
+{
+    if (state < 0 || state >= int(m_states.size()))
+    {
+        throw out_of_range("Unknown state " + to_string(state));
+    }
+}
+
+void EditableMachine::AddEdge(int from, int to)
+{
+    m_predecessors[to][from]++;
+}
+
+void EditableMachine::RemoveEdge(int from, int to)
+{
+    auto it = m_predecessors[to].find(from);
+    if (--it->second == 0)
+    {
+        m_predecessors[to].erase(it);
+    }
+}
+
+string EditableMachine::GetLocalKey(int state) const
+{
+    const State& current = m_states[state];
+    string key(1, current.output);
+    for (const auto& [input, transition] : current.transitions)
+    {
+        key += input;
+        key += transition.output;
+    }
+    return key;
+}
+
+EditableMachine::Signature EditableMachine::GetSignature(int state) const
+{
+    Signature signature{ GetLocalKey(state), {} };
+    for (const auto& [input, transition] : m_states[state].transitions)
+    {
+        signature.second.push_back(m_block[transition.target]);
+    }
+    return signature;
+}
+
+int EditableMachine::CreateBlock(const string& key)
+{
+    int block;
+    if (!m_freeBlocks.empty())
+    {
+        block = m_freeBlocks.back();
+        m_freeBlocks.pop_back();
+        m_blockKeys[block] = key;
+    }
+    else
+    {
+        block = int(m_members.size());
+        m_members.emplace_back();
+        m_blockKeys.push_back(key);
+    }
+    m_blocksByKey[key].insert(block);
+    return block;
+}
+
+void EditableMachine::SetBlockKey(int block, const string& key)
+{
+    if (m_blockKeys[block] == key)
+    {
+        return;
+    }
+    auto it = m_blocksByKey.find(m_blockKeys[block]);
+    it->second.erase(block);
+    if (it->second.empty())
+    {
+        m_blocksByKey.erase(it);
+    }
+    m_blockKeys[block] = key;
+    m_blocksByKey[key].insert(block);
+}
+
+void EditableMachine::RemoveFromBlock(int state)
+{
+    int block = m_block[state];
+    if (block == -1)
+    {
+        return;
+    }
+    m_block[state] = -1;
+    m_members[block].erase(state);
+    if (m_members[block].empty())
+    {
+        auto it = m_blocksByKey.find(m_blockKeys[block]);
+        it->second.erase(block);
+        if (it->second.empty())
+        {
+            m_blocksByKey.erase(it);
+        }
+        m_freeBlocks.push_back(block);
+    }
+}
+
+void EditableMachine::Touch(int state)
+{
+    const int block = m_block[state];
+    auto [it, inserted] = m_touched.try_emplace(block);
+    if (inserted)
+    {
+        m_splitQueue.push_back(block);
+    }
+    it->second.insert(state);
+}
+
+// Классы в порядке первого появления, класс начального состояния 0 идёт первым
+vector<int> EditableMachine::GetBlockOrder()
+{
+    Reminimize();
+
+    vector<int> order;
+    vector<bool> seen(m_members.size(), false);
+    for (int block : m_block)
+    {
+        if (!seen[block])
+        {
+            seen[block] = true;
+            order.push_back(block);
+        }
+    }
+    return order;
+}
@@ -0,0 +1,77 @@
+﻿#pragma once
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "Machine.h"
+
+// Автомат Мура или Мили, который хранит своё разбиение на классы эквивалентности
+// и после правок пересчитывает только затронутые классы.
+class EditableMachine
+{
+public:
+    explicit EditableMachine(const Moore::Machine& machine);
+    explicit EditableMachine(const Mealy::Machine& machine);
+
+    int AddState(char output = 0);
+    void SetTransition(int state, char input, int nextState, char output = 0);
+    void RemoveTransition(int state, char input);
+    void SetStateOutput(int state, char output);
+
+    void Reminimize();
+
+    int GetBlock(int state);
+    size_t GetBlockCount();
+    size_t GetStateCount() const;
+
+    Moore::Machine GetMinimizedMoore();
+    Mealy::Machine GetMinimizedMealy();
+
+private:
+    struct Transition
+    {
+        int target;
+        char output;
+    };
+
+    struct State
+    {
+        char output = 0;
+        std::map<char, Transition> transitions;
+    };
+
+    // Локальный ключ и классы преемников в порядке входных символов
+    using Signature = std::pair<std::string, std::vector<int>>;
+
+    void CheckState(int state) const;
+    void AddEdge(int from, int to);
+    void RemoveEdge(int from, int to);
+    std::string GetLocalKey(int state) const;
+    Signature GetSignature(int state) const;
+    int CreateBlock(const std::string& key);
+    void SetBlockKey(int block, const std::string& key);
+    void RemoveFromBlock(int state);
+    void Touch(int state);
+    void SplitTouchedBlocks(std::unordered_set<int>& changedBlocks);
+    void MergeEquivalentBlocks(const std::unordered_set<int>& changedBlocks);
+    void MergeBlocks(const std::vector<int>& blocks, std::vector<int>& queue);
+    std::vector<std::vector<int>> FindEquivalentBlocks(int first, int second) const;
+    std::vector<int> GetBlockOrder();
+
+    bool m_isMoore;
+    std::vector<State> m_states;
+    // Для каждого состояния: предшественник -> число рёбер из него
+    std::vector<std::unordered_map<int, int>> m_predecessors;
+
+    std::vector<int> m_block;
+    std::vector<std::unordered_set<int>> m_members;
+    std::vector<std::string> m_blockKeys;
+    std::vector<int> m_freeBlocks;
+    std::unordered_map<std::string, std::unordered_set<int>> m_blocksByKey;
+
+    std::unordered_set<int> m_dirty;
+    // Состояния, сигнатура которых могла измениться, по их классам, и очередь этих классов
+    std::unordered_map<int, std::unordered_set<int>> m_touched;
+    std::vector<int> m_splitQueue;
+};
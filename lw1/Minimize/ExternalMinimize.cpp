@@ -0,0 +1,722 @@
+﻿#include "Machine.h"
+#include "../../common/MappedFile.h"
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <queue>
+#include <random>
+#include <stdexcept>
+#include <string_view>
+
+namespace
+{
+    using namespace std;
+
+    const char SEPARATOR = ';';
+    const uint32_t START_STATE_ID = 0;
+    // Записей в буфере чтения или записи файла
+    const size_t IO_BUFFER_RECORDS = 1 << 16;
+    // Меньше этого сортировка в памяти теряет смысл
+    const size_t MIN_SORT_MEMORY = size_t(1) << 20;
+
+#pragma pack(push, 1)
+    // Переход; label - выход перехода + 1 у автомата Мили, 0 у автомата Мура.
+    // После соединения с разбиением target - блок цели.
+    struct EdgeRecord
+    {
+        uint32_t source;
+        uint32_t target;
+        uint8_t symbol;
+        uint8_t label;
+    };
+
+    struct StateRecord
+    {
+        uint32_t state;
+        uint32_t block;
+        uint8_t output;
+    };
+
+    struct SignatureRecord
+    {
+        uint64_t high;
+        uint64_t low;
+        uint32_t state;
+        uint8_t output;
+    };
+#pragma pack(pop)
+
+    struct BySourceSymbol
+    {
+        bool operator()(const EdgeRecord& a, const EdgeRecord& b) const
+        {
+            return a.source != b.source ? a.source < b.source : a.symbol < b.symbol;
+        }
+    };
+
+    struct ByTarget
+    {
+        bool operator()(const EdgeRecord& a, const EdgeRecord& b) const
+        {
+            return a.target < b.target;
+        }
+    };
+
+    struct ByState
+    {
+        bool operator()(const StateRecord& a, const StateRecord& b) const
+        {
+            return a.state < b.state;
+        }
+    };
+
+    struct BySignature
+    {
+        bool operator()(const SignatureRecord& a, const SignatureRecord& b) const
+        {
+            return a.high != b.high ? a.high < b.high : a.low < b.low;
+        }
+    };
+
+    // Временные файлы в каталоге scratchDirectory, удаляются вместе с объектом
+    class ScratchSpace
+    {
+    public:
+        explicit ScratchSpace(const string& directory)
+            : m_directory(directory)
+        {
+            if (!filesystem::is_directory(m_directory))
+            {
+                throw runtime_error("Scratch directory does not exist: " + directory);
+            }
+            random_device random;
+            m_prefix = "minimize_" + to_string(random()) + "_";
+        }
+
+        ScratchSpace(const ScratchSpace&) = delete;
+        ScratchSpace& operator=(const ScratchSpace&) = delete;
+
+        ~ScratchSpace()
+        {
+            for (const auto& file : m_files)
+            {
+                error_code error;
+                filesystem::remove(file, error);
+            }
+        }
+
+        string NewFile()
+        {
+            m_files.push_back((m_directory / (m_prefix + to_string(m_files.size()) + ".bin")).string());
+            return m_files.back();
+        }
+
+        void Remove(const string& file)
+        {
+            error_code error;
+            filesystem::remove(file, error);
+        }
+
+    private:
+        filesystem::path m_directory;
+        string m_prefix;
+        vector<string> m_files;
+    };
+
+    template <class Record>
+    class RecordWriter
+    {
+    public:
+        explicit RecordWriter(const string& fileName)
+            : m_fileName(fileName)
+            , m_file(fileName, ios::binary)
+        {
+            if (!m_file.is_open())
+            {
+                throw runtime_error("Failed to open scratch file " + fileName);
+            }
+            m_buffer.reserve(IO_BUFFER_RECORDS);
+        }
+
+        void Write(const Record& record)
+        {
+            m_buffer.push_back(record);
+            if (m_buffer.size() == IO_BUFFER_RECORDS)
+            {
+                Flush();
+            }
+        }
+
+        void Close()
+        {
+            Flush();
+            m_file.close();
+            if (m_file.fail())
+            {
+                throw runtime_error("Failed to write scratch file " + m_fileName);
+            }
+        }
+
+    private:
+        void Flush()
+        {
+            m_file.write(reinterpret_cast<const char*>(m_buffer.data()), streamsize(m_buffer.size() * sizeof(Record)));
+            if (!m_file)
+            {
+                throw runtime_error("Failed to write scratch file " + m_fileName);
+            }
+            m_buffer.clear();
+        }
+
+        string m_fileName;
+        ofstream m_file;
+        vector<Record> m_buffer;
+    };
+
+    template <class Record>
+    class RecordReader
+    {
+    public:
+        RecordReader(const string& fileName, size_t bufferRecords = IO_BUFFER_RECORDS)
+            : m_fileName(fileName)
+            , m_file(fileName, ios::binary)
+            , m_buffer(max<size_t>(bufferRecords, 1))
+        {
+            if (!m_file.is_open())
+            {
+                throw runtime_error("Failed to open scratch file " + fileName);
+            }
+            Fill();
+        }
+
+        // nullptr - записи кончились
+        const Record* Peek() const
+        {
+            return m_position < m_size ? &m_buffer[m_position] : nullptr;
+        }
+
+        void Pop()
+        {
+            if (++m_position == m_size)
+            {
+                Fill();
+            }
+        }
+
+    private:
+        void Fill()
+        {
+            m_file.read(reinterpret_cast<char*>(m_buffer.data()), streamsize(m_buffer.size() * sizeof(Record)));
+            if (m_file.bad() || m_file.gcount() % sizeof(Record) != 0)
+            {
+                throw runtime_error("Failed to read scratch file " + m_fileName);
+            }
+            m_size = size_t(m_file.gcount()) / sizeof(Record);
+            m_position = 0;
+        }
+
+        string m_fileName;
+        ifstream m_file;
+        vector<Record> m_buffer;
+        size_t m_size = 0;
+        size_t m_position = 0;
+    };
+
+    // Сортировка слиянием через диск: отсортированные куски по memoryLimit байт
+    // сбрасываются в файлы, Merge сливает их. Равные записи выходят в порядке Push.
+    template <class Record, class Less>
+    class ExternalSorter
+    {
+    public:
+        ExternalSorter(ScratchSpace& scratch, size_t memoryLimit)
+            : m_scratch(scratch)
+            , m_capacity(max(memoryLimit, MIN_SORT_MEMORY) / sizeof(Record))
+        {
+        }
+
+        void Push(const Record& record)
+        {
+            if (m_buffer.size() == m_capacity)
+            {
+                SpillRun();
+            }
+            else if (m_buffer.size() == m_buffer.capacity())
+            {
+                m_buffer.reserve(min(m_capacity, max<size_t>(m_buffer.capacity() * 2, IO_BUFFER_RECORDS)));
+            }
+            m_buffer.push_back(record);
+        }
+
+        template <class Fn>
+        void Merge(Fn fn)
+        {
+            stable_sort(m_buffer.begin(), m_buffer.end(), Less());
+            if (m_runs.empty())
+            {
+                for (const Record& record : m_buffer)
+                {
+                    fn(record);
+                }
+                vector<Record>().swap(m_buffer);
+                return;
+            }
+            if (!m_buffer.empty())
+            {
+                WriteRun();
+            }
+            vector<Record>().swap(m_buffer);
+
+            vector<unique_ptr<RecordReader<Record>>> readers;
+            for (const auto& run : m_runs)
+            {
+                readers.push_back(make_unique<RecordReader<Record>>(run, m_capacity / m_runs.size()));
+            }
+            // Наверху кучи - наименьшая запись, при равенстве - из более раннего куска
+            auto isAfter = [&readers](size_t a, size_t b) {
+                const Record& left = *readers[a]->Peek();
+                const Record& right = *readers[b]->Peek();
+                return Less()(right, left) || (!Less()(left, right) && a > b);
+            };
+            priority_queue<size_t, vector<size_t>, decltype(isAfter)> heap(isAfter);
+            for (size_t i = 0; i < readers.size(); i++)
+            {
+                if (readers[i]->Peek() != nullptr)
+                {
+                    heap.push(i);
+                }
+            }
+            while (!heap.empty())
+            {
+                size_t run = heap.top();
+                heap.pop();
+                fn(*readers[run]->Peek());
+                readers[run]->Pop();
+                if (readers[run]->Peek() != nullptr)
+                {
+                    heap.push(run);
+                }
+            }
+
+            readers.clear();
+            for (const auto& run : m_runs)
+            {
+                m_scratch.Remove(run);
+            }
+            m_runs.clear();
+        }
+
+    private:
+        void SpillRun()
+        {
+            stable_sort(m_buffer.begin(), m_buffer.end(), Less());
+            WriteRun();
+            m_buffer.clear();
+        }
+
+        void WriteRun()
+        {
+            m_runs.push_back(m_scratch.NewFile());
+            RecordWriter<Record> writer(m_runs.back());
+            for (const Record& record : m_buffer)
+            {
+                writer.Write(record);
+            }
+            writer.Close();
+        }
+
+        ScratchSpace& m_scratch;
+        size_t m_capacity;
+        vector<Record> m_buffer;
+        vector<string> m_runs;
+    };
+
+    struct Row
+    {
+        uint32_t source;
+        uint32_t target;
+        char symbol;
+        char output;
+    };
+
+    // Поля как в ReadFromFile: пустой символьный столбец даёт '\0'
+    class RowParser
+    {
+    public:
+        RowParser(const string& fileName, size_t line)
+            : m_fileName(fileName)
+            , m_line(line)
+        {
+        }
+
+        uint32_t ParseId(string_view field) const
+        {
+            while (!field.empty() && isspace(static_cast<unsigned char>(field.front())))
+            {
+                field.remove_prefix(1);
+            }
+            uint32_t value = 0;
+            auto [end, error] = from_chars(field.data(), field.data() + field.size(), value);
+            if (error != errc())
+            {
+                throw invalid_argument("Malformed machine file " + m_fileName + " at line " + to_string(m_line) + ": bad state id");
+            }
+            return value;
+        }
+
+        static char ParseChar(string_view field)
+        {
+            return field.empty() ? '\0' : field.front();
+        }
+
+    private:
+        const string& m_fileName;
+        size_t m_line;
+    };
+
+    // Строки после заголовка; fields - четыре столбца, недостающие пусты
+    template <class Fn>
+    void ForEachRow(const string& fileName, Fn fn)
+    {
+        MappedFile file(fileName);
+        string_view text(file.Data() == nullptr ? "" : file.Data(), file.Size());
+        size_t position = text.find('\n');
+        position = position == string_view::npos ? text.size() : position + 1;
+
+        array<string_view, 4> fields;
+        for (size_t line = 2; position < text.size(); line++)
+        {
+            size_t end = text.find('\n', position);
+            end = end == string_view::npos ? text.size() : end;
+            string_view row = text.substr(position, end - position);
+            position = end + 1;
+            if (!row.empty() && row.back() == '\r')
+            {
+                row.remove_suffix(1);
+            }
+
+            fields.fill({});
+            for (auto& field : fields)
+            {
+                size_t separator = row.find(SEPARATOR);
+                field = row.substr(0, separator);
+                if (separator == string_view::npos)
+                {
+                    break;
+                }
+                row.remove_prefix(separator + 1);
+            }
+            fn(fields, RowParser(fileName, line));
+        }
+    }
+
+    class Signature
+    {
+    public:
+        explicit Signature(uint32_t block)
+        {
+            Add(block);
+        }
+
+        void Add(uint64_t value)
+        {
+            m_high = (m_high ^ value) * 0x9E3779B97F4A7C15ULL;
+            m_high ^= m_high >> 32;
+            m_low = (m_low ^ value) * 0xC2B2AE3D27D4EB4FULL;
+            m_low ^= m_low >> 29;
+        }
+
+        SignatureRecord ToRecord(uint32_t state, uint8_t output) const
+        {
+            return { m_high, m_low, state, output };
+        }
+
+    private:
+        uint64_t m_high = 0x243F6A8885A308D3ULL;
+        uint64_t m_low = 0x13198A2E03707344ULL;
+    };
+
+    // Разбиение уточняется раундами из внешних сортировок:
+    // переходы (по цели) соединяются с блоками состояний, сортируются по источнику,
+    // каждому состоянию даётся 128-битная сигнатура (свой блок, символы, выходы и блоки целей),
+    // состояния с равными сигнатурами получают общий блок. Совпадение сигнатур разных ключей
+    // не проверяется: вероятность порядка n^2 / 2^128.
+    class ExternalMinimizer
+    {
+    public:
+        explicit ExternalMinimizer(const ExternalMinimizeOptions& options)
+            : m_scratch(options.scratchDirectory)
+            // Одновременно заполняются не больше двух сортировщиков
+            , m_sortMemory(options.memoryLimit / 2)
+        {
+        }
+
+        // parseRow(fields, parser) -> Row; у автомата Мура начальный блок - выход состояния
+        template <class ParseRow>
+        void Load(const string& inputFilePath, bool isMealy, ParseRow parseRow)
+        {
+            ExternalSorter<EdgeRecord, BySourceSymbol> edges(m_scratch, m_sortMemory);
+            ExternalSorter<StateRecord, ByState> states(m_scratch, m_sortMemory);
+            uint32_t lastSource = UINT32_MAX;
+            ForEachRow(inputFilePath, [&](const array<string_view, 4>& fields, const RowParser& parser) {
+                Row row = parseRow(fields, parser);
+                uint8_t label = isMealy ? uint8_t(uint8_t(row.output) + 1) : 0;
+                edges.Push({ row.source, row.target, uint8_t(row.symbol), label });
+                if (row.source != lastSource)
+                {
+                    states.Push({ row.source, isMealy ? 0u : uint32_t(uint8_t(row.output)), uint8_t(row.output) });
+                    lastSource = row.source;
+                }
+            });
+
+            // Выход состояния - из первой его строки
+            m_blocksFile = m_scratch.NewFile();
+            RecordWriter<StateRecord> blocksWriter(m_blocksFile);
+            array<bool, 256> usedBlocks{};
+            uint32_t previousState = UINT32_MAX;
+            states.Merge([&](const StateRecord& state) {
+                if (state.state == previousState)
+                {
+                    return;
+                }
+                previousState = state.state;
+                m_hasStart = m_hasStart || state.state == START_STATE_ID;
+                if (!usedBlocks[state.block])
+                {
+                    usedBlocks[state.block] = true;
+                    m_blockCount++;
+                }
+                blocksWriter.Write(state);
+            });
+            blocksWriter.Close();
+
+            // Повторный переход по тому же символу заменяет прежний
+            ExternalSorter<EdgeRecord, ByTarget> byTarget(m_scratch, m_sortMemory);
+            bool hasPrevious = false;
+            EdgeRecord previous{};
+            edges.Merge([&](const EdgeRecord& edge) {
+                if (hasPrevious && (edge.source != previous.source || edge.symbol != previous.symbol))
+                {
+                    byTarget.Push(previous);
+                }
+                previous = edge;
+                hasPrevious = true;
+            });
+            if (hasPrevious)
+            {
+                byTarget.Push(previous);
+            }
+            m_edgesFile = m_scratch.NewFile();
+            RecordWriter<EdgeRecord> edgesWriter(m_edgesFile);
+            byTarget.Merge([&](const EdgeRecord& edge) {
+                edgesWriter.Write(edge);
+            });
+            edgesWriter.Close();
+        }
+
+        bool HasStartState() const
+        {
+            return m_hasStart;
+        }
+
+        void Refine()
+        {
+            for (;;)
+            {
+                size_t blockCount = m_blockCount;
+                RefineRound();
+                if (m_blockCount == blockCount)
+                {
+                    return;
+                }
+            }
+        }
+
+        // Автомат из блоков; addState(block, output), addTransition(block, symbol, targetBlock, label).
+        // Блок начального состояния получает номер 0.
+        template <class AddState, class AddTransition>
+        void BuildQuotient(AddState addState, AddTransition addTransition)
+        {
+            ExternalSorter<EdgeRecord, BySourceSymbol> joined(m_scratch, m_sortMemory);
+            Join(joined);
+
+            uint32_t startBlock = 0;
+            {
+                RecordReader<StateRecord> states(m_blocksFile);
+                for (; states.Peek() != nullptr && states.Peek()->state != START_STATE_ID; states.Pop())
+                {
+                }
+                startBlock = states.Peek()->block;
+            }
+            auto renumber = [startBlock](uint32_t block) {
+                return block == startBlock ? 0 : block == 0 ? startBlock : block;
+            };
+
+            // Представитель блока - первое по номеру состояние
+            vector<bool> added(m_blockCount, false);
+            RecordReader<StateRecord> states(m_blocksFile);
+            bool isRepresentative = false;
+            uint32_t block = 0;
+            auto advance = [&](uint32_t state) {
+                for (; states.Peek() != nullptr && states.Peek()->state <= state; states.Pop())
+                {
+                    block = renumber(states.Peek()->block);
+                    isRepresentative = !added[block];
+                    if (isRepresentative)
+                    {
+                        added[block] = true;
+                        addState(block, char(states.Peek()->output));
+                    }
+                }
+            };
+            joined.Merge([&](const EdgeRecord& edge) {
+                advance(edge.source);
+                if (isRepresentative)
+                {
+                    addTransition(block, char(edge.symbol), renumber(edge.target), edge.label);
+                }
+            });
+            advance(UINT32_MAX);
+        }
+
+        size_t GetBlockCount() const
+        {
+            return m_blockCount;
+        }
+
+    private:
+        // Переходы с блоками целей вместо целей; переходы в состояния без строк в файле отбрасываются
+        void Join(ExternalSorter<EdgeRecord, BySourceSymbol>& joined)
+        {
+            RecordReader<EdgeRecord> edges(m_edgesFile);
+            RecordReader<StateRecord> states(m_blocksFile);
+            for (; edges.Peek() != nullptr; edges.Pop())
+            {
+                EdgeRecord edge = *edges.Peek();
+                while (states.Peek() != nullptr && states.Peek()->state < edge.target)
+                {
+                    states.Pop();
+                }
+                if (states.Peek() != nullptr && states.Peek()->state == edge.target)
+                {
+                    edge.target = states.Peek()->block;
+                    joined.Push(edge);
+                }
+            }
+        }
+
+        void RefineRound()
+        {
+            ExternalSorter<EdgeRecord, BySourceSymbol> joined(m_scratch, m_sortMemory);
+            Join(joined);
+
+            ExternalSorter<SignatureRecord, BySignature> signatures(m_scratch, m_sortMemory);
+            {
+                RecordReader<StateRecord> states(m_blocksFile);
+                StateRecord current{};
+                Signature signature(0);
+                bool hasCurrent = false;
+                // Состояния до state включительно получают сигнатуры, кроме последнего - оно набирается
+                auto advance = [&](uint32_t state) {
+                    for (; states.Peek() != nullptr && states.Peek()->state <= state; states.Pop())
+                    {
+                        if (hasCurrent)
+                        {
+                            signatures.Push(signature.ToRecord(current.state, current.output));
+                        }
+                        current = *states.Peek();
+                        signature = Signature(current.block);
+                        hasCurrent = true;
+                    }
+                };
+                joined.Merge([&](const EdgeRecord& edge) {
+                    advance(edge.source);
+                    signature.Add(edge.symbol | uint64_t(edge.label) << 8 | uint64_t(edge.target) << 16);
+                });
+                advance(UINT32_MAX);
+                if (hasCurrent)
+                {
+                    signatures.Push(signature.ToRecord(current.state, current.output));
+                }
+            }
+
+            ExternalSorter<StateRecord, ByState> blocks(m_scratch, m_sortMemory);
+            uint32_t blockCount = 0;
+            bool hasPrevious = false;
+            SignatureRecord previous{};
+            signatures.Merge([&](const SignatureRecord& record) {
+                if (hasPrevious && (record.high != previous.high || record.low != previous.low))
+                {
+                    blockCount++;
+                }
+                previous = record;
+                hasPrevious = true;
+                blocks.Push({ record.state, blockCount, record.output });
+            });
+
+            string blocksFile = m_scratch.NewFile();
+            RecordWriter<StateRecord> writer(blocksFile);
+            blocks.Merge([&](const StateRecord& state) {
+                writer.Write(state);
+            });
+            writer.Close();
+            m_scratch.Remove(m_blocksFile);
+            m_blocksFile = blocksFile;
+            m_blockCount = hasPrevious ? size_t(blockCount) + 1 : 0;
+        }
+
+        ScratchSpace m_scratch;
+        size_t m_sortMemory;
+        // Переходы, отсортированные по цели
+        string m_edgesFile;
+        // Блоки состояний, отсортированные по номеру состояния
+        string m_blocksFile;
+        size_t m_blockCount = 0;
+        bool m_hasStart = false;
+    };
+}
+
+Moore::Machine Moore::MinimizeExternal(const std::string& inputFilePath, const ExternalMinimizeOptions& options)
+{
+    ExternalMinimizer minimizer(options);
+    minimizer.Load(inputFilePath, false, [](const array<string_view, 4>& fields, const RowParser& parser) {
+        return Row{ parser.ParseId(fields[0]), parser.ParseId(fields[3]), RowParser::ParseChar(fields[2]), RowParser::ParseChar(fields[1]) };
+    });
+    if (!minimizer.HasStartState())
+    {
+        return {};
+    }
+    minimizer.Refine();
+
+    Machine quotient(minimizer.GetBlockCount());
+    minimizer.BuildQuotient([&](uint32_t block, char output) {
+        quotient[block].id = int(block);
+        quotient[block].output = output;
+    }, [&](uint32_t block, char symbol, uint32_t target, uint8_t) {
+        quotient[block].transitions[symbol] = int(target);
+    });
+    return Moore::Canonicalize(quotient);
+}
+
+Mealy::Machine Mealy::MinimizeExternal(const std::string& inputFilePath, const ExternalMinimizeOptions& options)
+{
+    ExternalMinimizer minimizer(options);
+    minimizer.Load(inputFilePath, true, [](const array<string_view, 4>& fields, const RowParser& parser) {
+        return Row{ parser.ParseId(fields[0]), parser.ParseId(fields[2]), RowParser::ParseChar(fields[1]), RowParser::ParseChar(fields[3]) };
+    });
+    if (!minimizer.HasStartState())
+    {
+        return {};
+    }
+    minimizer.Refine();
+
+    Machine quotient(minimizer.GetBlockCount());
+    minimizer.BuildQuotient([&](uint32_t block, char) {
+        quotient[block].id = int(block);
+    }, [&](uint32_t block, char symbol, uint32_t target, uint8_t label) {
+        quotient[block].transitions[symbol] = { int(target), char(label - 1) };
+    });
+    return Mealy::Canonicalize(quotient);
+}
@@ -5,13 +5,247 @@
 #include <sstream>
 #include <set>
 #include <algorithm>
-#include <queue>
+#include "../../common/Trim.h"
 
 namespace
 {
 	using namespace std;
 
     const char SEPARATOR = ';';
+    const int START_STATE_ID = 0;
+
+    pair<int, char> KeyOf(int transition)
+    {
+        return { transition, 0 };
+    }
+
+    pair<int, char> KeyOf(const pair<int, char>& transition)
+    {
+        return transition;
+    }
+
+    //    :  ( )    
+    template <class State>
+    SymbolClasses GetMachineSymbolClasses(const vector<State>& machine)
+    {
+        set<char> symbols;
+        for (const State& state : machine)
+        {
+            for (const auto& [input, transition] : state.transitions)
+            {
+                symbols.insert(input);
+            }
+        }
+
+        SymbolClasses classes;
+        classes.classOf.fill(-1);
+        map<vector<pair<int, char>>, short> classOfColumn;
+        vector<pair<int, char>> column;
+        for (char symbol : symbols)
+        {
+            column.clear();
+            for (const State& state : machine)
+            {
+                auto it = state.transitions.find(symbol);
+                column.push_back(it == state.transitions.end() ? pair<int, char>(-1, 0) : KeyOf(it->second));
+            }
+            auto [it, inserted] = classOfColumn.try_emplace(column, short(classes.representatives.size()));
+            if (inserted)
+            {
+                classes.representatives.push_back(symbol);
+            }
+            classes.classOf[static_cast<unsigned char>(symbol)] = it->second;
+        }
+
+        return classes;
+    }
+
+    //   ,   ,    
+    template <class State>
+    vector<State> TrimMachine(const vector<State>& machine)
+    {
+        int maxId = -1;
+        for (const State& state : machine)
+        {
+            maxId = max(maxId, state.id);
+        }
+
+        vector<int> indexOfId(maxId + 1, -1);
+        for (size_t i = 0; i < machine.size(); i++)
+        {
+            //  id :    getIndex  
+            if (machine[i].id >= 0)
+            {
+                indexOfId[machine[i].id] = int(i);
+            }
+        }
+        auto getIndex = [&indexOfId](int id) {
+            return id >= 0 && id < int(indexOfId.size()) ? indexOfId[id] : -1;
+        };
+
+        vector<pair<uint32_t, uint32_t>> edges;
+        for (size_t i = 0; i < machine.size(); i++)
+        {
+            for (const auto& [input, transition] : machine[i].transitions)
+            {
+                int target = getIndex(TargetOf(transition));
+                if (target != -1)
+                {
+                    edges.emplace_back(uint32_t(i), uint32_t(target));
+                }
+            }
+        }
+
+        vector<uint32_t> initial;
+        if (getIndex(START_STATE_ID) != -1)
+        {
+            initial.push_back(uint32_t(getIndex(START_STATE_ID)));
+        }
+        Bitset useful = FindReachable(BuildCsr(machine.size(), edges), initial);
+
+        vector<int> newIds(machine.size(), -1);
+        int newId = 0;
+        for (size_t i = 0; i < machine.size(); i++)
+        {
+            if (useful.Test(i))
+            {
+                newIds[i] = newId++;
+            }
+        }
+
+        vector<State> trimmed;
+        trimmed.reserve(newId);
+        for (size_t i = 0; i < machine.size(); i++)
+        {
+            if (newIds[i] == -1)
+            {
+                continue;
+            }
+            State state = machine[i];
+            state.id = newIds[i];
+            for (auto it = state.transitions.begin(); it != state.transitions.end();)
+            {
+                int target = getIndex(TargetOf(it->second));
+                if (target == -1 || newIds[target] == -1)
+                {
+                    it = state.transitions.erase(it);
+                    continue;
+                }
+                TargetOf(it->second) = newIds[target];
+                ++it;
+            }
+            trimmed.push_back(move(state));
+        }
+
+        return trimmed;
+    }
+
+    //    ,   
+    class MemoryBuffer : public streambuf
+    {
+    public:
+        explicit MemoryBuffer(string_view text)
+        {
+            char* begin = const_cast<char*>(text.data());
+            setg(begin, begin, begin + text.size());
+        }
+    };
+
+    Mealy::Machine ReadMealyMachine(istream& input)
+    {
+        vector<Mealy::State> states;
+        string line, header;
+
+        getline(input, header);
+
+        map<int, Mealy::State> stateMap;
+
+        while (getline(input, line))
+        {
+            stringstream ss(line);
+            string idStr, inputStr, nextStateStr, outputStr;
+
+            getline(ss, idStr, SEPARATOR);
+            getline(ss, inputStr, SEPARATOR);
+            getline(ss, nextStateStr, SEPARATOR);
+            getline(ss, outputStr, SEPARATOR);
+
+            int id = stoi(idStr);
+            char inputSymbol = inputStr[0];
+            int nextState = stoi(nextStateStr);
+            char output = outputStr[0];
+
+            if (stateMap.find(id) == stateMap.end())
+            {
+                Mealy::State newState;
+                newState.id = id;
+                stateMap[id] = newState;
+            }
+
+            stateMap[id].transitions[inputSymbol] = { nextState, output };
+        }
+
+        for (const auto& [id, state] : stateMap)
+        {
+            states.push_back(state);
+        }
+
+        return states;
+    }
+
+    Moore::Machine ReadMooreMachine(istream& input)
+    {
+        vector<Moore::State> states;
+        string line, header;
+
+        getline(input, header);
+
+        map<int, Moore::State> stateMap;
+
+        while (getline(input, line))
+        {
+            stringstream ss(line);
+            string idStr, outputStr, inputStr, nextStateStr;
+
+            getline(ss, idStr, SEPARATOR);
+            getline(ss, outputStr, SEPARATOR);
+            getline(ss, inputStr, SEPARATOR);
+            getline(ss, nextStateStr, SEPARATOR);
+
+            int id = stoi(idStr);
+            char output = outputStr[0];
+            char inputSymbol = inputStr[0];
+            int nextState = stoi(nextStateStr);
+
+            if (stateMap.find(id) == stateMap.end())
+            {
+                Moore::State newState;
+                newState.id = id;
+                newState.output = output;
+                stateMap[id] = newState;
+            }
+
+            stateMap[id].transitions[inputSymbol] = nextState;
+        }
+
+        for (const auto& [id, state] : stateMap)
+        {
+            states.push_back(state);
+        }
+
+        return states;
+    }
+
+    template <class State>
+    map<int, size_t> GetIndexOfId(const vector<State>& machine)
+    {
+        map<int, size_t> indexOfId;
+        for (size_t i = 0; i < machine.size(); i++)
+        {
+            indexOfId[machine[i].id] = i;
+        }
+        return indexOfId;
+    }
 
 	namespace MooreUtils
 	{
@@ -30,7 +264,8 @@ namespace
             }
         }
 
-        bool SplitByTransitions(vector<set<int>>& partitions, const vector<Moore::State>& states)
+        //          ,    
+        bool SplitByTransitions(vector<set<int>>& partitions, const vector<Moore::State>& states, const SymbolClasses& classes)
         {
             vector<set<int>> newPartitions;
             bool partitionChanged = false;
@@ -42,13 +277,18 @@ namespace
                 for (int state : partition)
                 {
                     map<char, int> transitionKey;
-                    for (const auto& transition : states[state].transitions)
+                    for (char input : classes.representatives)
                     {
+                        auto transition = states[state].transitions.find(input);
+                        if (transition == states[state].transitions.end())
+                        {
+                            continue;
+                        }
                         for (size_t i = 0; i < partitions.size(); ++i)
                         {
-                            if (partitions[i].count(transition.second))
+                            if (partitions[i].count(transition->second))
                             {
-                                transitionKey[transition.first] = i;
+                                transitionKey[input] = i;
                                 break;
                             }
                         }
@@ -71,48 +311,14 @@ namespace
             return partitionChanged;
         }
 
-        Moore::Machine RemoveUnreachableStates(const Moore::Machine& mooreAutomaton)
-        {
-            vector<MooreState> reachableStates;
-            set<int> visited;
-            queue<int> toVisit;
-
-            toVisit.push(0);
-            visited.insert(0);
-
-            while (!toVisit.empty()) {
-                int currentStateId = toVisit.front();
-                toVisit.pop();
-
-                for (const MooreState& state : mooreAutomaton)
-                {
-                    if (state.id == currentStateId)
-                    {
-                        reachableStates.push_back(state);
-
-                        for (const auto& [input, nextState] : state.transitions)
-                        {
-                            if (visited.find(nextState) == visited.end())
-                            {
-                                toVisit.push(nextState);
-                                visited.insert(nextState);
-                            }
-                        }
-                        break;
-                    }
-                }
-            }
-
-            return reachableStates;
-        }
-
         vector<set<int>> MinimizeMooreAutomaton(const vector<Moore::State>& states)
         {
             vector<set<int>> partitions;
+            SymbolClasses classes = Moore::GetSymbolClasses(states);
 
             SplitByOutput(partitions, states);
 
-            while (SplitByTransitions(partitions, states))
+            while (SplitByTransitions(partitions, states, classes))
             {
             }
 
@@ -229,16 +435,20 @@ namespace
 
 	namespace MealyUtils
 	{
-        void SplitByTransitions(vector<set<int>>& partitions, const vector<Mealy::State>& states)
+        void SplitByTransitions(vector<set<int>>& partitions, const vector<Mealy::State>& states, const SymbolClasses& classes)
         {
             map<map<char, char>, set<int>> transitionGroups;
 
             for (const auto& state : states)
             {
                 map<char, char> outputs;
-                for (const auto& transition : state.transitions)
+                for (char input : classes.representatives)
                 {
-                    outputs[transition.first] = transition.second.second;
+                    auto transition = state.transitions.find(input);
+                    if (transition != state.transitions.end())
+                    {
+                        outputs[input] = transition->second.second;
+                    }
                 }
                 transitionGroups[outputs].insert(state.id);
             }
@@ -249,7 +459,7 @@ namespace
             }
         }
 
-        bool SplitByNextStateAndOutput(vector<set<int>>& partitions, const vector<Mealy::State>& states)
+        bool SplitByNextStateAndOutput(vector<set<int>>& partitions, const vector<Mealy::State>& states, const SymbolClasses& classes)
         {
             vector<set<int>> newPartitions;
             bool partitionChanged = false;
@@ -261,16 +471,20 @@ namespace
                 for (int state : partition)
                 {
                     map<char, int> transitionKey;
-                    for (const auto& transition : states[state].transitions)
+                    for (char input : classes.representatives)
                     {
-                        int nextState = transition.second.first;
-                        char output = transition.second.second;
+                        auto transition = states[state].transitions.find(input);
+                        if (transition == states[state].transitions.end())
+                        {
+                            continue;
+                        }
+                        int nextState = transition->second.first;
 
                         for (size_t i = 0; i < partitions.size(); ++i)
                         {
                             if (partitions[i].count(nextState))
                             {
-                                transitionKey[transition.first] = i;
+                                transitionKey[input] = i;
                                 break;
                             }
                         }
@@ -296,49 +510,17 @@ namespace
         vector<set<int>> MinimizeMealyAutomaton(const vector<Mealy::State>& states)
         {
             vector<set<int>> partitions;
+            SymbolClasses classes = Mealy::GetSymbolClasses(states);
 
-            SplitByTransitions(partitions, states);
+            SplitByTransitions(partitions, states, classes);
 
-            while (SplitByNextStateAndOutput(partitions, states))
+            while (SplitByNextStateAndOutput(partitions, states, classes))
             {
             }
 
             return partitions;
         }
 
-        Mealy::Machine RemoveUnreachableStates(const Mealy::Machine& mealyAutomaton) {
-            vector<MealyState> reachableStates;
-            set<int> visited;
-            queue<int> toVisit;
-
-            toVisit.push(0);
-            visited.insert(0);
-
-            while (!toVisit.empty())
-            {
-                int currentStateId = toVisit.front();
-                toVisit.pop();
-
-                for (const MealyState& state : mealyAutomaton) {
-                    if (state.id == currentStateId) {
-                        reachableStates.push_back(state);
-
-                        //      
-                        for (const auto& [input, transition] : state.transitions) {
-                            int nextState = transition.first;
-                            if (visited.find(nextState) == visited.end()) {
-                                toVisit.push(nextState);
-                                visited.insert(nextState);
-                            }
-                        }
-                        break;
-                    }
-                }
-            }
-
-            return reachableStates;
-        }
-
         vector<Mealy::State> GetMinimizedStates(const vector<Mealy::State>& states, const vector<set<int>>& minimizedPartitions)
         {
             vector<Mealy::State> minimizedStates;
@@ -445,99 +627,38 @@ Mealy::Machine Mealy::ReadFromFile(std::string const& inputFilePath)
 {
     ifstream file;
     OpenFile(file, inputFilePath);
-
-    vector<Mealy::State> states;
-    string line, header;
-
-    getline(file, header);
-
-    map<int, Mealy::State> stateMap;
-
-    while (getline(file, line))
-    {
-        stringstream ss(line);
-        string idStr, inputStr, nextStateStr, outputStr;
-
-        getline(ss, idStr, SEPARATOR);
-        getline(ss, inputStr, SEPARATOR);
-        getline(ss, nextStateStr, SEPARATOR);
-        getline(ss, outputStr, SEPARATOR);
-
-        int id = stoi(idStr);
-        char input = inputStr[0];
-        int nextState = stoi(nextStateStr);
-        char output = outputStr[0];
-
-        if (stateMap.find(id) == stateMap.end())
-        {
-            Mealy::State newState;
-            newState.id = id;
-            stateMap[id] = newState;
-        }
-
-        stateMap[id].transitions[input] = { nextState, output };
-    }
-
-    for (const auto& [id, state] : stateMap)
-    {
-        states.push_back(state);
-    }
-
+    Machine machine = ReadMealyMachine(file);
     CheckFileRuntime(file);
-    file.close();
-    return states;
+    return machine;
+}
+
+Mealy::Machine Mealy::ReadFromMemory(std::string_view text)
+{
+    MemoryBuffer buffer(text);
+    istream input(&buffer);
+    return ReadMealyMachine(input);
 }
 
 Moore::Machine Moore::ReadFromFile(std::string const& inputFilePath)
 {
     ifstream file;
     OpenFile(file, inputFilePath);
-
-    vector<Moore::State> states;
-    string line, header;
-
-    getline(file, header);
-
-    map<int, Moore::State> stateMap;
-
-    while (getline(file, line))
-    {
-        stringstream ss(line);
-        string idStr, outputStr, inputStr, nextStateStr;
-
-        getline(ss, idStr, SEPARATOR);
-        getline(ss, outputStr, SEPARATOR);
-        getline(ss, inputStr, SEPARATOR);
-        getline(ss, nextStateStr, SEPARATOR);
-
-        int id = stoi(idStr);
-        char output = outputStr[0];
-        char input = inputStr[0];
-        int nextState = stoi(nextStateStr);
-
-        if (stateMap.find(id) == stateMap.end())
-        {
-            Moore::State newState;
-            newState.id = id;
-            newState.output = output;
-            stateMap[id] = newState;
-        }
-
-        stateMap[id].transitions[input] = nextState;
-    }
-
-    for (const auto& [id, state] : stateMap)
-    {
-        states.push_back(state);
-    }
-
+    Machine machine = ReadMooreMachine(file);
     CheckFileRuntime(file);
-    file.close();
-    return states;
+    return machine;
 }
 
-Mealy::Machine Moore::ToMealy(Moore::Machine& machine)
+Moore::Machine Moore::ReadFromMemory(std::string_view text)
+{
+    MemoryBuffer buffer(text);
+    istream input(&buffer);
+    return ReadMooreMachine(input);
+}
+
+//   ,    , 
+Mealy::Machine Moore::ConvertToMealy(const Machine& machine)
 {
+    auto indexOfId = GetIndexOfId(machine);
     vector<Mealy::State> mealyAutomaton;
 
     for (const Moore::State& mooreState : machine)
@@ -547,22 +668,43 @@ Mealy::Machine Moore::ToMealy(Moore::Machine& machine)
 
         for (const auto& [input, nextState] : mooreState.transitions)
         {
-            auto nextStateOutput = machine[nextState].output;
-            mealyState.transitions[input] = { nextState, nextStateOutput };
+            auto it = indexOfId.find(nextState);
+            if (it != indexOfId.end())
+            {
+                mealyState.transitions[input] = { nextState, machine[it->second].output };
+            }
         }
 
         mealyAutomaton.push_back(mealyState);
     }
 
+    return mealyAutomaton;
+}
+
+Mealy::Machine Moore::ToMealy(Moore::Machine& machine)
+{
+    vector<Mealy::State> mealyAutomaton = ConvertToMealy(machine);
+
     MealyUtils::Print(mealyAutomaton);
     MealyUtils::Visualize(mealyAutomaton, "transformed_mealy.png");
 
     return mealyAutomaton;
 }
 
+SymbolClasses Moore::GetSymbolClasses(const Machine& machine)
+{
+    return GetMachineSymbolClasses(machine);
+}
+
+Moore::Machine Moore::Trim(const Machine& machine)
+{
+    return TrimMachine(machine);
+}
+
 Moore::Machine Moore::Minimize(Machine& machine)
 {
-    vector<set<int>> minimizedPartitions = MooreUtils::MinimizeMooreAutomaton(machine);
+    Machine trimmed = Moore::Trim(machine);
+    vector<set<int>> minimizedPartitions = MooreUtils::MinimizeMooreAutomaton(trimmed);
 
     sort(minimizedPartitions.begin(), minimizedPartitions.end(),
         [](const set<int>& a, const set<int>& b) -> bool
@@ -570,8 +712,7 @@ Moore::Machine Moore::Minimize(Machine& machine)
             return *a.begin() < *b.begin();
         });
 
-    Moore::Machine minimizedStates = MooreUtils::GetMinimizedStates(machine, minimizedPartitions);
-    minimizedStates = MooreUtils::RemoveUnreachableStates(minimizedStates);
+    Moore::Machine minimizedStates = Moore::Canonicalize(MooreUtils::GetMinimizedStates(trimmed, minimizedPartitions));
 
     MooreUtils::Print(minimizedStates);
     MooreUtils::Visualize(minimizedStates, "minimized_moore.png");
@@ -579,67 +720,88 @@ Moore::Machine Moore::Minimize(Machine& machine)
     return minimizedStates;
 }
 
-Moore::Machine Mealy::ToMoore(Machine& machine)
+//   -  ( ,   ),  -   
+//  .     ,      .
+Moore::Machine Mealy::ConvertToMoore(const Machine& machine)
 {
-    vector<Moore::State> mooreAutomaton;
-    map<pair<int, char>, int> stateMapping;
-    vector<char> outputs;
-    int newStateId = 0;
+    auto indexOfId = GetIndexOfId(machine);
+    if (machine.empty())
+    {
+        return {};
+    }
 
+    size_t start = indexOfId.count(START_STATE_ID) ? indexOfId[START_STATE_ID] : 0;
+    char startOutput = 0;
+    bool hasIncoming = false;
     for (const Mealy::State& mealyState : machine)
     {
         for (const auto& [input, transition] : mealyState.transitions)
         {
-            int nextState = transition.first;
-            char output = transition.second;
-
-            if (stateMapping.find({ mealyState.id, output }) == stateMapping.end())
-            {
-                Moore::State newState;
-                newState.id = newStateId++;
-                newState.output = output;
-                mooreAutomaton.push_back(newState);
-                stateMapping[{mealyState.id, output}] = newState.id;
-            }
-
-            if (find(outputs.begin(), outputs.end(), output) == outputs.end())
+            if (transition.first == machine[start].id && (!hasIncoming || transition.second < startOutput))
             {
-                outputs.push_back(output);
+                startOutput = transition.second;
+                hasIncoming = true;
             }
         }
     }
 
-    for (const Mealy::State& mealyState : machine)
-    {
-        for (const auto& [input, transition] : mealyState.transitions)
+    vector<Moore::State> mooreAutomaton;
+    vector<size_t> mealyIndexOf;
+    map<pair<size_t, char>, int> stateMapping;
+    auto getMooreState = [&](size_t mealyIndex, char output) {
+        auto [it, inserted] = stateMapping.try_emplace({ mealyIndex, output }, int(mooreAutomaton.size()));
+        if (inserted)
         {
-            int nextState = transition.first;
-            char output = transition.second;
+            Moore::State newState;
+            newState.id = it->second;
+            newState.output = output;
+            mooreAutomaton.push_back(newState);
+            mealyIndexOf.push_back(mealyIndex);
+        }
+        return it->second;
+    };
 
-            for (const auto& output : outputs)
+    getMooreState(start, startOutput);
+    for (size_t i = 0; i < mooreAutomaton.size(); i++)
+    {
+        for (const auto& [input, transition] : machine[mealyIndexOf[i]].transitions)
+        {
+            auto it = indexOfId.find(transition.first);
+            if (it != indexOfId.end())
             {
-                if (stateMapping.find({ mealyState.id, output }) != stateMapping.end())
-                {
-                    int mooreCurrentStateId = stateMapping[{mealyState.id, output}];
-
-                    char nextOutput = machine[nextState].transitions.begin()->second.second;
-                    int mooreNextStateId = stateMapping[{nextState, nextOutput}];
-
-                    mooreAutomaton[mooreCurrentStateId].transitions[input] = mooreNextStateId;
-                }
+                int nextState = getMooreState(it->second, transition.second);
+                mooreAutomaton[i].transitions[input] = nextState;
             }
         }
     }
 
+    return mooreAutomaton;
+}
+
+Moore::Machine Mealy::ToMoore(Machine& machine)
+{
+    vector<Moore::State> mooreAutomaton = ConvertToMoore(machine);
+
     MooreUtils::Print(mooreAutomaton);
     MooreUtils::Visualize(mooreAutomaton, "transformed_moore.png");
 
     return mooreAutomaton;
 }
 
+SymbolClasses Mealy::GetSymbolClasses(const Machine& machine)
+{
+    return GetMachineSymbolClasses(machine);
+}
+
+Mealy::Machine Mealy::Trim(const Machine& machine)
+{
+    return TrimMachine(machine);
+}
+
 Mealy::Machine Mealy::Minimize(Machine& machine)
 {
-    vector<set<int>> minimizedPartitions = MealyUtils::MinimizeMealyAutomaton(machine);
+    Machine trimmed = Mealy::Trim(machine);
+    vector<set<int>> minimizedPartitions = MealyUtils::MinimizeMealyAutomaton(trimmed);
 
     sort(minimizedPartitions.begin(), minimizedPartitions.end(),
         [](const set<int>& a, const set<int>& b) -> bool
@@ -647,8 +809,7 @@ Mealy::Machine Mealy::Minimize(Machine& machine)
             return *a.begin() < *b.begin();
         });
 
-    vector<Mealy::State> minimizedStates = MealyUtils::GetMinimizedStates(machine, minimizedPartitions);
-    minimizedStates = MealyUtils::RemoveUnreachableStates(minimizedStates);
+    vector<Mealy::State> minimizedStates = Mealy::Canonicalize(MealyUtils::GetMinimizedStates(trimmed, minimizedPartitions));
 
     MealyUtils::Print(minimizedStates);
     MealyUtils::Visualize(minimizedStates, "minimized_mealy.png");
@@ -1,7 +1,13 @@
-#pragma once
+﻿#pragma once
+#include <array>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <map>
+#include <cstdint>
+#include "../../common/ContentHash.h"
+
+struct CodegenTable;
 
 struct MooreState
 {
@@ -16,14 +22,63 @@ struct MealyState
     std::map<char, std::pair<int, char>> transitions;
 };
 
+// Номер следующего состояния в переходе автомата Мура или Мили
+inline int& TargetOf(int& transition)
+{
+    return transition;
+}
+
+inline int& TargetOf(std::pair<int, char>& transition)
+{
+    return transition.first;
+}
+
+inline int TargetOf(const int& transition)
+{
+    return transition;
+}
+
+inline int TargetOf(const std::pair<int, char>& transition)
+{
+    return transition.first;
+}
+
+// Входные символы, переходы по которым совпадают во всех состояниях, объединены в классы
+struct SymbolClasses
+{
+    // Класс каждого байта, -1 - символ в автомате не встречается
+    std::array<short, 256> classOf;
+    // Первый символ каждого класса
+    std::vector<char> representatives;
+};
+
+// Минимизация без загрузки автомата: переходы сортируются во временных файлах каталога scratchDirectory
+struct ExternalMinimizeOptions
+{
+    std::string scratchDirectory = ".";
+    // Память под буферы сортировки, байт
+    size_t memoryLimit = size_t(1) << 30;
+};
+
 namespace Moore
 {
     using State = MooreState;
     using Machine = std::vector<State>;
 
+    Machine Trim(const Machine& machine);
     Machine Minimize(Machine& machine);
+    // Разбиение уточняется по 64-битным сигнатурам на всех ядрах (threadCount == 0), без печати
+    Machine MinimizeParallel(const Machine& machine, size_t threadCount = 0);
+    Machine MinimizeExternal(const std::string& inputFilePath, const ExternalMinimizeOptions& options);
+    Machine Canonicalize(const Machine& machine);
+    Hash128 GetContentHash(const Machine& machine);
+    SymbolClasses GetSymbolClasses(const Machine& machine);
+    // Преобразование без печати и картинки
+    std::vector<MealyState> ConvertToMealy(const Machine& machine);
     std::vector<MealyState> ToMealy(Machine& machine);
     Machine ReadFromFile(std::string const& inputFilePath);
+    // Текст в формате файла, буфер после возврата не нужен
+    Machine ReadFromMemory(std::string_view text);
 }
 
 namespace Mealy
@@ -31,7 +86,16 @@ namespace Mealy
     using State = MealyState;
     using Machine = std::vector<State>;
 
+    Machine Trim(const Machine& machine);
     Machine Minimize(Machine& machine);
+    Machine MinimizeParallel(const Machine& machine, size_t threadCount = 0);
+    Machine MinimizeExternal(const std::string& inputFilePath, const ExternalMinimizeOptions& options);
+    Machine Canonicalize(const Machine& machine);
+    Hash128 GetContentHash(const Machine& machine);
+    SymbolClasses GetSymbolClasses(const Machine& machine);
+    CodegenTable GetCodegenTable(const Machine& machine, const std::string& name);
+    std::vector<MooreState> ConvertToMoore(const Machine& machine);
     std::vector<MooreState> ToMoore(Machine& machine);
     Machine ReadFromFile(std::string const& inputFilePath);
+    Machine ReadFromMemory(std::string_view text);
 }
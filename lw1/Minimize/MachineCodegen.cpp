@@ -0,0 +1,36 @@
+﻿#include "Machine.h"
+#include "../../common/CodeGen.h"
+
+using namespace std;
+
+CodegenTable Mealy::GetCodegenTable(const Machine& machine, const string& name)
+{
+    // После канонизации номера состояний плотные, начальное состояние 0
+    Machine canonical = Canonicalize(machine);
+
+    // Классы те же, что у таблицы Transducer
+    const SymbolClasses classes = GetSymbolClasses(canonical);
+
+    CodegenTable table;
+    table.name = name;
+    table.stateCount = int(canonical.size());
+    for (int byte = 0; byte < 256; byte++)
+    {
+        if (classes.classOf[byte] != -1)
+        {
+            table.symbols.push_back(char(byte));
+            table.symbolClasses.push_back(classes.classOf[byte]);
+        }
+    }
+    for (const auto& state : canonical)
+    {
+        for (char symbol : table.symbols)
+        {
+            auto it = state.transitions.find(symbol);
+            table.next.push_back(it == state.transitions.end() ? -1 : it->second.first);
+            table.outputs.push_back(it == state.transitions.end() ? char(0) : it->second.second);
+        }
+    }
+
+    return table;
+}
@@ -0,0 +1,346 @@
+﻿#include "Machine.h"
+#include "../../common/ParallelRun.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace
+{
+    using namespace std;
+
+    // Пустые и отсутствующие значения в сигнатуре
+    const uint32_t NO_VALUE = UINT32_MAX;
+    // Корзин на поток при разбиении по старшим битам сигнатуры
+    const size_t BUCKETS_PER_THREAD = 8;
+
+    inline uint64_t Mix(uint64_t hash, uint64_t value)
+    {
+        hash = (hash ^ value) * 0x9E3779B97F4A7C15ULL;
+        return hash ^ (hash >> 32);
+    }
+
+    // Переходы по классам символов хранятся по столбцам: next[symbolClass * n + state],
+    // отсутствующий переход ведёт в фиктивное состояние n. Сигнатуры раунда считаются
+    // столбец за столбцом по отрезку состояний: цикл без ветвлений компилятор векторизует.
+    class Refiner
+    {
+    public:
+        Refiner(size_t stateCount, size_t threadCount)
+            : m_stateCount(stateCount)
+            , m_threadCount(threadCount == 0 ? GetHardwareThreadCount() : threadCount)
+            , m_signatures(stateCount)
+            , m_order(stateCount)
+            , m_local(stateCount)
+        {
+            size_t bucketCount = 1;
+            m_shift = 64;
+            while (bucketCount < m_threadCount * BUCKETS_PER_THREAD && bucketCount * 2 <= max<size_t>(stateCount, 1))
+            {
+                bucketCount *= 2;
+                m_shift--;
+            }
+            m_bucketCount = bucketCount;
+        }
+
+        // Новые блоки: состояния с одинаковыми base и значениями column(c, s) во всех столбцах.
+        // Возвращает число блоков; блоки нумеруются подряд с 0.
+        template <class Column>
+        size_t Split(const vector<uint32_t>& base, size_t columnCount, Column column, vector<uint32_t>& blocks)
+        {
+            const size_t n = m_stateCount;
+            ParallelFor(n, m_threadCount, [&](size_t, size_t begin, size_t end) {
+                for (size_t s = begin; s < end; s++)
+                {
+                    m_signatures[s] = Mix(0, base[s]);
+                }
+                for (size_t c = 0; c < columnCount; c++)
+                {
+                    for (size_t s = begin; s < end; s++)
+                    {
+                        m_signatures[s] = Mix(m_signatures[s], column(c, s));
+                    }
+                }
+            });
+
+            auto isEqual = [&](uint32_t a, uint32_t b) {
+                if (base[a] != base[b])
+                {
+                    return false;
+                }
+                for (size_t c = 0; c < columnCount; c++)
+                {
+                    if (column(c, a) != column(c, b))
+                    {
+                        return false;
+                    }
+                }
+                return true;
+            };
+            auto isLess = [&](uint32_t a, uint32_t b) {
+                if (base[a] != base[b])
+                {
+                    return base[a] < base[b];
+                }
+                for (size_t c = 0; c < columnCount; c++)
+                {
+                    if (column(c, a) != column(c, b))
+                    {
+                        return column(c, a) < column(c, b);
+                    }
+                }
+                return a < b;
+            };
+
+            // Разбиение по корзинам: счёт по отрезкам потоков, затем раскладка
+            vector<vector<size_t>> counts(m_threadCount, vector<size_t>(m_bucketCount, 0));
+            ParallelFor(n, m_threadCount, [&](size_t t, size_t begin, size_t end) {
+                for (size_t s = begin; s < end; s++)
+                {
+                    counts[t][GetBucket(m_signatures[s])]++;
+                }
+            });
+            vector<size_t> bucketOffsets(m_bucketCount + 1, 0);
+            size_t offset = 0;
+            for (size_t bucket = 0; bucket < m_bucketCount; bucket++)
+            {
+                bucketOffsets[bucket] = offset;
+                for (size_t t = 0; t < m_threadCount; t++)
+                {
+                    size_t count = counts[t][bucket];
+                    counts[t][bucket] = offset;
+                    offset += count;
+                }
+            }
+            bucketOffsets[m_bucketCount] = offset;
+            ParallelFor(n, m_threadCount, [&](size_t t, size_t begin, size_t end) {
+                for (size_t s = begin; s < end; s++)
+                {
+                    m_order[counts[t][GetBucket(m_signatures[s])]++] = uint32_t(s);
+                }
+            });
+
+            // Внутри корзины - сортировка по сигнатуре; при совпадении сигнатур разных ключей
+            // группа досортировывается по самим ключам
+            vector<size_t> groupCounts(m_bucketCount, 0);
+            ParallelFor(m_bucketCount, m_threadCount, [&](size_t, size_t first, size_t last) {
+                for (size_t bucket = first; bucket < last; bucket++)
+                {
+                    auto begin = m_order.begin() + bucketOffsets[bucket];
+                    auto end = m_order.begin() + bucketOffsets[bucket + 1];
+                    sort(begin, end, [this](uint32_t a, uint32_t b) {
+                        return m_signatures[a] != m_signatures[b] ? m_signatures[a] < m_signatures[b] : a < b;
+                    });
+
+                    uint32_t local = 0;
+                    for (auto group = begin; group != end;)
+                    {
+                        auto groupEnd = group + 1;
+                        bool exact = true;
+                        while (groupEnd != end && m_signatures[*groupEnd] == m_signatures[*group])
+                        {
+                            exact = exact && isEqual(*group, *groupEnd);
+                            ++groupEnd;
+                        }
+                        if (!exact)
+                        {
+                            sort(group, groupEnd, isLess);
+                        }
+                        for (auto it = group; it != groupEnd; ++it)
+                        {
+                            if (it != group && !isEqual(*(it - 1), *it))
+                            {
+                                local++;
+                            }
+                            m_local[*it] = local;
+                        }
+                        local++;
+                        group = groupEnd;
+                    }
+                    groupCounts[bucket] = local;
+                }
+            });
+
+            vector<uint32_t> firstBlock(m_bucketCount, 0);
+            size_t blockCount = 0;
+            for (size_t bucket = 0; bucket < m_bucketCount; bucket++)
+            {
+                firstBlock[bucket] = uint32_t(blockCount);
+                blockCount += groupCounts[bucket];
+            }
+            ParallelFor(n, m_threadCount, [&](size_t, size_t begin, size_t end) {
+                for (size_t s = begin; s < end; s++)
+                {
+                    blocks[s] = firstBlock[GetBucket(m_signatures[s])] + m_local[s];
+                }
+            });
+            return blockCount;
+        }
+
+    private:
+        size_t GetBucket(uint64_t signature) const
+        {
+            return m_shift == 64 ? 0 : size_t(signature >> m_shift);
+        }
+
+        size_t m_stateCount;
+        size_t m_threadCount;
+        size_t m_bucketCount = 1;
+        int m_shift = 64;
+        vector<uint64_t> m_signatures;
+        vector<uint32_t> m_order;
+        vector<uint32_t> m_local;
+    };
+
+    template <class State>
+    vector<uint32_t> FlattenTransitions(const vector<State>& machine, const SymbolClasses& classes, size_t threadCount)
+    {
+        const size_t n = machine.size();
+        vector<uint32_t> next(classes.representatives.size() * n);
+        ParallelFor(n, threadCount, [&](size_t, size_t begin, size_t end) {
+            for (size_t s = begin; s < end; s++)
+            {
+                for (size_t c = 0; c < classes.representatives.size(); c++)
+                {
+                    auto it = machine[s].transitions.find(classes.representatives[c]);
+                    next[c * n + s] = it == machine[s].transitions.end() ? uint32_t(n) : uint32_t(TargetOf(it->second));
+                }
+            }
+        });
+        return next;
+    }
+
+    // Уточнение до неподвижной точки: блок состояния и блоки его преемников.
+    // blocks на входе - начальное разбиение, размер n + 1, blocks[n] = NO_VALUE.
+    void RefineToFixpoint(Refiner& refiner, const vector<uint32_t>& next, size_t classCount, vector<uint32_t>& blocks, size_t blockCount)
+    {
+        const size_t n = blocks.size() - 1;
+        vector<uint32_t> newBlocks(n + 1, NO_VALUE);
+        for (;;)
+        {
+            size_t newCount = refiner.Split(blocks, classCount, [&](size_t c, size_t s) {
+                return blocks[next[c * n + s]];
+            }, newBlocks);
+            blocks.swap(newBlocks);
+            if (newCount == blockCount)
+            {
+                return;
+            }
+            blockCount = newCount;
+        }
+    }
+
+    // Блок начального состояния получает номер 0, как после сортировки разбиений в Minimize
+    template <class State, class Fill>
+    vector<State> BuildMinimized(const vector<State>& machine, const vector<uint32_t>& blocks, Fill fill)
+    {
+        const size_t n = machine.size();
+        size_t blockCount = 0;
+        for (size_t s = 0; s < n; s++)
+        {
+            blockCount = max<size_t>(blockCount, blocks[s] + 1);
+        }
+        vector<uint32_t> remap(blockCount);
+        for (size_t block = 0; block < blockCount; block++)
+        {
+            remap[block] = uint32_t(block);
+        }
+        if (n > 0)
+        {
+            swap(remap[0], remap[blocks[0]]);
+        }
+
+        vector<State> minimized(blockCount);
+        vector<char> done(blockCount, false);
+        for (size_t s = 0; s < n; s++)
+        {
+            uint32_t block = remap[blocks[s]];
+            if (done[block])
+            {
+                continue;
+            }
+            done[block] = true;
+            minimized[block].id = int(block);
+            fill(minimized[block], machine[s], [&](int target) {
+                return int(remap[blocks[target]]);
+            });
+        }
+        return minimized;
+    }
+}
+
+Moore::Machine Moore::MinimizeParallel(const Machine& machine, size_t threadCount)
+{
+    Machine trimmed = Moore::Trim(machine);
+    const size_t n = trimmed.size();
+    if (n >= NO_VALUE)
+    {
+        throw length_error("Machine has too many states");
+    }
+    threadCount = threadCount == 0 ? GetHardwareThreadCount() : threadCount;
+    SymbolClasses classes = Moore::GetSymbolClasses(trimmed);
+    vector<uint32_t> next = FlattenTransitions(trimmed, classes, threadCount);
+
+    Refiner refiner(n, threadCount);
+    vector<uint32_t> outputs(n);
+    for (size_t s = 0; s < n; s++)
+    {
+        outputs[s] = static_cast<unsigned char>(trimmed[s].output);
+    }
+    vector<uint32_t> blocks(n + 1, NO_VALUE);
+    size_t blockCount = refiner.Split(outputs, 0, [](size_t, size_t) {
+        return NO_VALUE;
+    }, blocks);
+    RefineToFixpoint(refiner, next, classes.representatives.size(), blocks, blockCount);
+
+    return Moore::Canonicalize(BuildMinimized(trimmed, blocks, [](State& result, const State& state, auto blockOf) {
+        result.output = state.output;
+        for (const auto& [input, target] : state.transitions)
+        {
+            result.transitions[input] = blockOf(target);
+        }
+    }));
+}
+
+Mealy::Machine Mealy::MinimizeParallel(const Machine& machine, size_t threadCount)
+{
+    Machine trimmed = Mealy::Trim(machine);
+    const size_t n = trimmed.size();
+    if (n >= NO_VALUE)
+    {
+        throw length_error("Machine has too many states");
+    }
+    threadCount = threadCount == 0 ? GetHardwareThreadCount() : threadCount;
+    SymbolClasses classes = Mealy::GetSymbolClasses(trimmed);
+    const size_t classCount = classes.representatives.size();
+    vector<uint32_t> next = FlattenTransitions(trimmed, classes, threadCount);
+
+    // Начальное разбиение - по выходам всех переходов
+    vector<uint32_t> outputs(classCount * n, NO_VALUE);
+    ParallelFor(n, threadCount, [&](size_t, size_t begin, size_t end) {
+        for (size_t s = begin; s < end; s++)
+        {
+            for (size_t c = 0; c < classCount; c++)
+            {
+                auto it = trimmed[s].transitions.find(classes.representatives[c]);
+                if (it != trimmed[s].transitions.end())
+                {
+                    outputs[c * n + s] = static_cast<unsigned char>(it->second.second);
+                }
+            }
+        }
+    });
+
+    Refiner refiner(n, threadCount);
+    vector<uint32_t> blocks(n + 1, NO_VALUE);
+    size_t blockCount = refiner.Split(vector<uint32_t>(n, 0), classCount, [&](size_t c, size_t s) {
+        return outputs[c * n + s];
+    }, blocks);
+    outputs = {};
+    RefineToFixpoint(refiner, next, classCount, blocks, blockCount);
+
+    return Mealy::Canonicalize(BuildMinimized(trimmed, blocks, [](State& result, const State& state, auto blockOf) {
+        for (const auto& [input, transition] : state.transitions)
+        {
+            result.transitions[input] = { blockOf(transition.first), transition.second };
+        }
+    }));
+}
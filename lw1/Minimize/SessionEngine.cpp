@@ -0,0 +1,130 @@
+﻿#include "SessionEngine.h"
+#include <algorithm>
+#include <stdexcept>
+
+using namespace std;
+
+SessionEngine::SessionEngine(Transducer transducer)
+    : m_transducer(move(transducer))
+{
+}
+
+uint32_t SessionEngine::AddSession()
+{
+    m_sessionCount++;
+    if (!m_freeSessions.empty())
+    {
+        uint32_t session = m_freeSessions.back();
+        m_freeSessions.pop_back();
+        m_states[session] = m_transducer.GetStartState();
+        return session;
+    }
+    if (m_states.size() >= UINT32_MAX)
+    {
+        throw length_error("Too many sessions");
+    }
+    m_states.push_back(m_transducer.GetStartState());
+    return uint32_t(m_states.size() - 1);
+}
+
+void SessionEngine::RemoveSession(uint32_t session)
+{
+    CheckSession(session);
+    m_states[session] = REMOVED_STATE;
+    m_freeSessions.push_back(session);
+    m_sessionCount--;
+}
+
+void SessionEngine::ResetSession(uint32_t session)
+{
+    CheckSession(session);
+    m_states[session] = m_transducer.GetStartState();
+}
+
+int SessionEngine::GetState(uint32_t session) const
+{
+    CheckSession(session);
+    return m_states[session];
+}
+
+size_t SessionEngine::GetSessionCount() const
+{
+    return m_sessionCount;
+}
+
+void SessionEngine::CheckSession(uint32_t session) const
+{
+    if (session >= m_states.size() || m_states[session] == REMOVED_STATE)
+    {
+        throw out_of_range("Unknown session " + to_string(session));
+    }
+}
+
+// Ключи упаковываются в uint64_t: старшая половина - сеанс или состояние, младшая - номер события
+size_t SessionEngine::Apply(const SessionEvent* events, size_t count, char* outputs)
+{
+    if (count > UINT32_MAX)
+    {
+        throw length_error("Too many events in a batch");
+    }
+    for (size_t i = 0; i < count; i++)
+    {
+        CheckSession(events[i].session);
+    }
+
+    // Номер события внутри своего сеанса: k-й раунд применяет k-е события всех сеансов
+    m_keys.resize(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        m_keys[i] = (uint64_t(events[i].session) << 32) | i;
+    }
+    sort(m_keys.begin(), m_keys.end());
+
+    m_rankOffsets.assign(2, 0);
+    m_ranks.resize(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        uint32_t rank = i > 0 && (m_keys[i] >> 32) == (m_keys[i - 1] >> 32) ? m_ranks[uint32_t(m_keys[i - 1])] + 1 : 0;
+        m_ranks[uint32_t(m_keys[i])] = rank;
+        if (rank + 2 > m_rankOffsets.size())
+        {
+            m_rankOffsets.push_back(0);
+        }
+        m_rankOffsets[rank + 1]++;
+    }
+    for (size_t rank = 1; rank < m_rankOffsets.size(); rank++)
+    {
+        m_rankOffsets[rank] += m_rankOffsets[rank - 1];
+    }
+    // События раундов подряд, внутри раунда - в порядке прихода
+    m_positions.assign(m_rankOffsets.begin(), m_rankOffsets.end() - 1);
+    for (size_t i = 0; i < count; i++)
+    {
+        m_keys[m_positions[m_ranks[i]]++] = i;
+    }
+
+    size_t rejected = 0;
+    for (size_t rank = 0; rank + 1 < m_rankOffsets.size(); rank++)
+    {
+        auto begin = m_keys.begin() + m_rankOffsets[rank];
+        auto end = m_keys.begin() + m_rankOffsets[rank + 1];
+        for (auto it = begin; it != end; ++it)
+        {
+            uint32_t event = uint32_t(*it);
+            *it = (uint64_t(uint32_t(m_states[events[event].session])) << 32) | event;
+        }
+        sort(begin, end);
+
+        for (auto it = begin; it != end; ++it)
+        {
+            const SessionEvent& event = events[uint32_t(*it)];
+            int& state = m_states[event.session];
+            char output = REJECTED_OUTPUT;
+            int next = state < 0 ? -1 : m_transducer.GetNextState(state, event.symbol, output);
+            rejected += next < 0;
+            state = next < 0 ? BROKEN_STATE : next;
+            outputs[uint32_t(*it)] = next < 0 ? REJECTED_OUTPUT : output;
+        }
+    }
+    return rejected;
+}
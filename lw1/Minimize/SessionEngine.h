@@ -0,0 +1,50 @@
+﻿#pragma once
+#include <cstdint>
+#include <vector>
+#include "Transducer.h"
+
+// Событие сеанса: входной символ для автомата одного соединения
+struct SessionEvent
+{
+    uint32_t session;
+    char symbol;
+};
+
+// Много сеансов одного автомата: у сеанса только номер состояния в общем массиве.
+// События применяются пакетами: в пределах сеанса - по порядку, а между сеансами
+// сгруппированы по состоянию, чтобы строки таблицы переходов читались подряд.
+class SessionEngine
+{
+public:
+    // Состояние сеанса после перехода, которого нет в автомате; до ResetSession события отклоняются
+    static const int BROKEN_STATE = -1;
+    // Выход отклонённого события
+    static const char REJECTED_OUTPUT = '\0';
+
+    explicit SessionEngine(Transducer transducer);
+
+    // Номера удалённых сеансов используются повторно
+    uint32_t AddSession();
+    void RemoveSession(uint32_t session);
+    void ResetSession(uint32_t session);
+    int GetState(uint32_t session) const;
+    size_t GetSessionCount() const;
+
+    // outputs[i] - выход события events[i]. Возвращает число отклонённых событий.
+    size_t Apply(const SessionEvent* events, size_t count, char* outputs);
+
+private:
+    static const int REMOVED_STATE = -2;
+
+    void CheckSession(uint32_t session) const;
+
+    Transducer m_transducer;
+    std::vector<int> m_states;
+    std::vector<uint32_t> m_freeSessions;
+    size_t m_sessionCount = 0;
+    // Рабочие массивы пакета, чтобы не выделять память на каждый вызов
+    std::vector<uint64_t> m_keys;
+    std::vector<uint32_t> m_ranks;
+    std::vector<uint32_t> m_rankOffsets;
+    std::vector<uint32_t> m_positions;
+};
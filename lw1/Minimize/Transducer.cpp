@@ -0,0 +1,275 @@
+﻿#include "Transducer.h"
+#include "../../common/MappedFile.h"
+#include "../../common/ParallelRun.h"
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+
+using namespace std;
+
+Transducer::Transducer(const SymbolClasses& classes, size_t stateCount)
+    : m_stride(classes.representatives.size() + 1)
+    , m_stateCount(max<size_t>(stateCount, 1))
+{
+    if (stateCount > MAX_STATE_COUNT)
+    {
+        throw length_error("Machine has too many states for a transducer table");
+    }
+    for (size_t byte = 0; byte < 256; byte++)
+    {
+        m_byteClass[byte] = uint16_t(classes.classOf[byte] + 1);
+    }
+    m_table.assign(m_stateCount * m_stride, NO_TRANSITION);
+}
+
+void Transducer::SetTransition(int state, short symbolClass, int target, char output)
+{
+    m_table[state * m_stride + symbolClass + 1] = (uint32_t(target) << 8) | uint8_t(output);
+}
+
+// После канонизации начальное состояние 0, номера плотные
+Transducer Transducer::FromMealy(const Mealy::Machine& machine)
+{
+    Mealy::Machine canonical = Mealy::Canonicalize(machine);
+    SymbolClasses classes = Mealy::GetSymbolClasses(canonical);
+    Transducer transducer(classes, canonical.size());
+    for (const auto& state : canonical)
+    {
+        for (short symbolClass = 0; symbolClass < short(classes.representatives.size()); symbolClass++)
+        {
+            auto it = state.transitions.find(classes.representatives[symbolClass]);
+            if (it != state.transitions.end())
+            {
+                transducer.SetTransition(state.id, symbolClass, it->second.first, it->second.second);
+            }
+        }
+    }
+    return transducer;
+}
+
+Transducer Transducer::FromMoore(const Moore::Machine& machine)
+{
+    Moore::Machine canonical = Moore::Canonicalize(machine);
+    SymbolClasses classes = Moore::GetSymbolClasses(canonical);
+    Transducer transducer(classes, canonical.size());
+    for (const auto& state : canonical)
+    {
+        for (short symbolClass = 0; symbolClass < short(classes.representatives.size()); symbolClass++)
+        {
+            auto it = state.transitions.find(classes.representatives[symbolClass]);
+            if (it != state.transitions.end())
+            {
+                transducer.SetTransition(state.id, symbolClass, it->second, canonical[it->second].output);
+            }
+        }
+    }
+    return transducer;
+}
+
+size_t Transducer::Run(int& state, const char* input, size_t size, char* out) const
+{
+    const uint32_t* table = m_table.data();
+    size_t row = size_t(state) * m_stride;
+    size_t i = 0;
+    for (; i < size; i++)
+    {
+        const uint32_t cell = table[row + m_byteClass[static_cast<unsigned char>(input[i])]];
+        if (cell == NO_TRANSITION)
+        {
+            break;
+        }
+        out[i] = char(cell);
+        row = size_t(cell >> 8) * m_stride;
+    }
+    state = int(row / m_stride);
+    return i;
+}
+
+Transducer::RunResult Transducer::RunStream(const Reader& reader, const Writer& writer, size_t bufferSize) const
+{
+    vector<char> input(bufferSize), output(bufferSize);
+    RunResult result;
+    result.state = GetStartState();
+    for (;;)
+    {
+        size_t size = reader(input.data(), input.size());
+        if (size == 0)
+        {
+            break;
+        }
+        size_t consumed = Run(result.state, input.data(), size, output.data());
+        writer(output.data(), consumed);
+        result.consumed += consumed;
+        if (consumed < size)
+        {
+            result.stopped = true;
+            break;
+        }
+    }
+    return result;
+}
+
+Transducer::RunResult Transducer::RunFile(const string& inputFileName, const string& outputFileName, size_t threadCount) const
+{
+    MappedFile input(inputFileName);
+    ofstream output(outputFileName, ios::binary);
+    if (!output.is_open())
+    {
+        throw runtime_error("Failed to open file " + outputFileName);
+    }
+
+    if (threadCount == 0)
+    {
+        threadCount = GetHardwareThreadCount();
+    }
+    const size_t window = threadCount <= 1 ? DEFAULT_BUFFER_SIZE : threadCount * PARALLEL_WINDOW_PER_THREAD;
+    vector<char> buffer(min(window, input.Size()));
+    RunResult result;
+    result.state = GetStartState();
+    for (size_t offset = 0; offset < input.Size(); offset += window)
+    {
+        size_t size = min(window, input.Size() - offset);
+        size_t consumed = RunParallel(result.state, input.Data() + offset, size, buffer.data(), threadCount);
+        output.write(buffer.data(), streamsize(consumed));
+        result.consumed += consumed;
+        if (consumed < size)
+        {
+            result.stopped = true;
+            break;
+        }
+    }
+
+    if (!output.flush())
+    {
+        throw runtime_error("Failed to write in output file");
+    }
+    return result;
+}
+
+size_t Transducer::RunParallel(int& state, const char* input, size_t size, char* out, size_t threadCount) const
+{
+    if (threadCount == 0)
+    {
+        threadCount = GetHardwareThreadCount();
+    }
+    const size_t chunkCount = min(threadCount, size / MIN_PARALLEL_CHUNK);
+    if (chunkCount <= 1)
+    {
+        return Run(state, input, size, out);
+    }
+
+    struct Chunk
+    {
+        size_t begin = 0;
+        size_t size = 0;
+        StateMapping mapping;
+        // Состояние и число обработанных символов после прогона с позиции схождения
+        int state = -1;
+        size_t consumed = 0;
+        // Настоящее начальное состояние, известно после компоновки
+        int start = -1;
+    };
+    vector<Chunk> chunks(chunkCount);
+    for (size_t i = 0; i < chunkCount; i++)
+    {
+        chunks[i].begin = size * i / chunkCount;
+        chunks[i].size = size * (i + 1) / chunkCount - chunks[i].begin;
+    }
+
+    auto step = [this](int from, char symbol) {
+        char output;
+        return GetNextState(from, symbol, output);
+    };
+    ParallelFor(chunkCount, chunkCount, [&](size_t, size_t first, size_t last) {
+        for (size_t i = first; i < last; i++)
+        {
+            Chunk& chunk = chunks[i];
+            const char* begin = input + chunk.begin;
+            if (i == 0)
+            {
+                chunk.state = state;
+                chunk.consumed = Run(chunk.state, begin, chunk.size, out);
+                continue;
+            }
+            chunk.mapping = MapStates(m_stateCount, begin, chunk.size, step);
+            size_t convergedAt = chunk.mapping.convergedAt;
+            chunk.consumed = convergedAt;
+            if (convergedAt < chunk.size)
+            {
+                auto live = find_if(chunk.mapping.stateAt.begin(), chunk.mapping.stateAt.end(), [](int s) {
+                    return s >= 0;
+                });
+                if (live != chunk.mapping.stateAt.end())
+                {
+                    chunk.state = *live;
+                    chunk.consumed += Run(chunk.state, begin + convergedAt, chunk.size - convergedAt, out + chunk.begin + convergedAt);
+                }
+            }
+        }
+    });
+
+    // Настоящие начальные состояния кусков - по порядку
+    size_t lastChunk = 0;
+    size_t consumed = chunks[0].consumed;
+    state = chunks[0].state;
+    bool stopped = consumed < chunks[0].size;
+    for (size_t i = 1; i < chunkCount && !stopped; i++)
+    {
+        Chunk& chunk = chunks[i];
+        chunk.start = state;
+        lastChunk = i;
+        int at = chunk.mapping.stateAt[state];
+        if (at < 0)
+        {
+            // Остановка до схождения, место найдёт повторный прогон
+            stopped = true;
+            break;
+        }
+        state = chunk.mapping.convergedAt == chunk.size ? at : chunk.state;
+        consumed = chunk.begin + chunk.consumed;
+        stopped = chunk.consumed < chunk.size;
+    }
+
+    // Выходы до схождения; для куска с остановкой повторный прогон даёт и её место
+    vector<size_t> prefixConsumed(lastChunk + 1, 0);
+    vector<int> prefixState(lastChunk + 1, -1);
+    ParallelFor(lastChunk, lastChunk, [&](size_t, size_t first, size_t last) {
+        for (size_t i = first + 1; i <= last; i++)
+        {
+            prefixState[i] = chunks[i].start;
+            prefixConsumed[i] = Run(prefixState[i], input + chunks[i].begin, chunks[i].mapping.convergedAt, out + chunks[i].begin);
+        }
+    });
+    if (lastChunk > 0 && chunks[lastChunk].mapping.stateAt[chunks[lastChunk].start] < 0)
+    {
+        state = prefixState[lastChunk];
+        consumed = chunks[lastChunk].begin + prefixConsumed[lastChunk];
+    }
+    return consumed;
+}
+
+int Transducer::GetStartState() const
+{
+    return 0;
+}
+
+size_t Transducer::GetStateCount() const
+{
+    return m_stateCount;
+}
+
+size_t Transducer::GetClassCount() const
+{
+    return m_stride - 1;
+}
+
+int Transducer::GetNextState(int state, char input, char& output) const
+{
+    const uint32_t cell = m_table[state * m_stride + m_byteClass[static_cast<unsigned char>(input)]];
+    if (cell == NO_TRANSITION)
+    {
+        return -1;
+    }
+    output = char(cell);
+    return int(cell >> 8);
+}
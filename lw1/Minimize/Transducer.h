@@ -0,0 +1,67 @@
+﻿#pragma once
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+#include "Machine.h"
+
+// Исполнение автомата Мили или Мура по плоской таблице: на каждый входной символ пишется
+// один выходной (у Мили - выход перехода, у Мура - выход состояния, в которое перешли).
+// Таблица только читается, один объект можно использовать из многих потоков.
+class Transducer
+{
+public:
+    struct RunResult
+    {
+        // Обработано символов, столько же записано выходов
+        size_t consumed = 0;
+        int state = 0;
+        // Остановились перед символом, по которому из state нет перехода
+        bool stopped = false;
+    };
+
+    // Возвращает число прочитанных в buffer байт, 0 - конец входа
+    using Reader = std::function<size_t(char* buffer, size_t capacity)>;
+    using Writer = std::function<void(const char* data, size_t size)>;
+
+    static const size_t DEFAULT_BUFFER_SIZE = 1 << 16;
+
+    static Transducer FromMealy(const Mealy::Machine& machine);
+    static Transducer FromMoore(const Moore::Machine& machine);
+
+    // Продолжает с состояния state; out должен вмещать size символов.
+    // Возвращает число обработанных символов, state - состояние после них.
+    size_t Run(int& state, const char* input, size_t size, char* out) const;
+    // То же на нескольких потоках: куски входа прогоняются из всех состояний сразу (см. MapStates),
+    // выходы до схождения запусков дописываются, когда известны настоящие начальные состояния кусков.
+    // threadCount == 0 - по числу ядер.
+    size_t RunParallel(int& state, const char* input, size_t size, char* out, size_t threadCount = 0) const;
+    RunResult RunStream(const Reader& reader, const Writer& writer, size_t bufferSize = DEFAULT_BUFFER_SIZE) const;
+    // Вход отображается в память и обрабатывается окнами, выход пишется по окну
+    RunResult RunFile(const std::string& inputFileName, const std::string& outputFileName, size_t threadCount = 1) const;
+
+    int GetStartState() const;
+    size_t GetStateCount() const;
+    size_t GetClassCount() const;
+    // Следующее состояние или -1 и выход перехода по символу, для пакетной и параллельной обработки
+    int GetNextState(int state, char input, char& output) const;
+
+private:
+    // Ячейка: номер следующего состояния в старших 24 битах, выход в младших 8
+    static const uint32_t NO_TRANSITION = UINT32_MAX;
+    // Состояние 0xFFFFFF с выходом 0xFF совпало бы с NO_TRANSITION, поэтому оно не используется
+    static const size_t MAX_STATE_COUNT = (size_t(1) << 24) - 1;
+    // Меньшие куски не окупают запуск потока
+    static const size_t MIN_PARALLEL_CHUNK = 1 << 16;
+    static const size_t PARALLEL_WINDOW_PER_THREAD = 1 << 24;
+
+    Transducer(const SymbolClasses& classes, size_t stateCount);
+    void SetTransition(int state, short symbolClass, int target, char output);
+
+    // Класс байта + 1; столбец 0 - символы вне алфавита, переходов по нему нет
+    std::array<uint16_t, 256> m_byteClass;
+    size_t m_stride = 1;
+    size_t m_stateCount = 0;
+    std::vector<uint32_t> m_table;
+};
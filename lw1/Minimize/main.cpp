@@ -1,6 +1,10 @@
 ﻿#include "Machine.h"
+#include "Transducer.h"
+#include "../../common/CodeGen.h"
 #include <string>
 #include <iostream>
+#include <fstream>
+#include <stdexcept>
 
 namespace
 {
@@ -17,32 +21,76 @@ namespace
         cin >> input;
         return input;
     }
+
+    void GenerateMachineCode(const Mealy::Machine& machine)
+    {
+        cout << "Choose code style 'direct' or 'table': ";
+        auto style = ParseCodegenStyle(ReadInput());
+        cout << "Enter output file path: ";
+        auto outputFilePath = ReadInput();
+
+        ofstream output(outputFilePath);
+        if (!output.is_open())
+        {
+            throw runtime_error("Cannot open file: " + outputFilePath);
+        }
+        GenerateCode(Mealy::GetCodegenTable(machine, "machine"), style, output);
+    }
+
+    ExternalMinimizeOptions ReadExternalMinimizeOptions()
+    {
+        ExternalMinimizeOptions options;
+        cout << "Enter scratch directory: ";
+        options.scratchDirectory = ReadInput();
+        cout << "Enter memory limit in MB: ";
+        options.memoryLimit = stoull(ReadInput()) << 20;
+        return options;
+    }
+
+    void RunMachine(const Transducer& transducer)
+    {
+        cout << "Enter symbols file path: ";
+        auto symbolsFilePath = ReadInput();
+        cout << "Enter output file path: ";
+        auto outputFilePath = ReadInput();
+        cout << "Enter thread count (0 - all cores): ";
+        auto threadCount = stoull(ReadInput());
+
+        auto result = transducer.RunFile(symbolsFilePath, outputFilePath, threadCount);
+        cout << "Processed " << result.consumed << " symbols" << endl;
+        if (result.stopped)
+        {
+            cout << "No transition for symbol at offset " << result.consumed << endl;
+        }
+    }
 }
 
 int main()
 {
     cout << "Enter input file path: ";
     auto inputFilePath = ReadInput();
-    cout << "Choose mode 'min' or 'trans': ";
+    cout << "Choose mode 'min', 'pmin', 'xmin', 'trans', 'hash', 'gen' or 'run': ";
     auto mode = ReadInput();
     bool isMoore = IsSubstring(inputFilePath, "_moore_");
     bool isMealy = IsSubstring(inputFilePath, "_mealy_");
 
+    if (!isMoore && !isMealy)
+    {
+        cout << "Unknown machine type" << endl;
+        return EXIT_FAILURE;
+    }
+
+    // Для 'xmin' автомат в память не загружается, его заменит минимизированный
     Mealy::Machine mealyMachine;
     Moore::Machine mooreMachine;
-    if (isMoore)
+    if (mode != "xmin" && isMoore)
     {
         mooreMachine = Moore::ReadFromFile(inputFilePath);
     }
-    else if (isMealy)
+    else if (mode != "xmin" && isMealy)
     {
         mealyMachine = Mealy::ReadFromFile(inputFilePath);
     }
-    else
-    {
-        cout << "Unknown machine type" << endl;
-        return EXIT_FAILURE;
-    }
 
     do
     {
@@ -57,6 +105,61 @@ int main()
                 mealyMachine = Mealy::Minimize(mealyMachine);
             }
         }
+        else if (mode == "pmin")
+        {
+            cout << "Enter thread count (0 - all cores): ";
+            auto threadCount = stoull(ReadInput());
+            size_t stateCount = 0;
+            if (isMoore)
+            {
+                mooreMachine = Moore::MinimizeParallel(mooreMachine, threadCount);
+                stateCount = mooreMachine.size();
+            }
+            else if (isMealy)
+            {
+                mealyMachine = Mealy::MinimizeParallel(mealyMachine, threadCount);
+                stateCount = mealyMachine.size();
+            }
+            cout << "Minimized to " << stateCount << " states" << endl;
+        }
+        else if (mode == "xmin")
+        {
+            // Минимизируется входной файл, а не текущий автомат
+            auto options = ReadExternalMinimizeOptions();
+            isMoore = IsSubstring(inputFilePath, "_moore_");
+            isMealy = !isMoore;
+            size_t stateCount = 0;
+            if (isMoore)
+            {
+                mooreMachine = Moore::MinimizeExternal(inputFilePath, options);
+                stateCount = mooreMachine.size();
+            }
+            else
+            {
+                mealyMachine = Mealy::MinimizeExternal(inputFilePath, options);
+                stateCount = mealyMachine.size();
+            }
+            cout << "Minimized to " << stateCount << " states" << endl;
+        }
+        else if (mode == "hash")
+        {
+            // Хеш канонической формы минимального автомата: у эквивалентных автоматов он совпадает,
+            // текущий автомат не меняется
+            cout << "Minimized content hash: "
+                << (isMoore
+                    ? Moore::GetContentHash(Moore::MinimizeParallel(mooreMachine))
+                    : Mealy::GetContentHash(Mealy::MinimizeParallel(mealyMachine))).ToString()
+                << endl;
+        }
+        else if (mode == "gen")
+        {
+            // Автомат Мура генерируется через эквивалентный автомат Мили
+            GenerateMachineCode(isMoore ? Moore::ConvertToMealy(mooreMachine) : mealyMachine);
+        }
+        else if (mode == "run")
+        {
+            RunMachine(isMoore ? Transducer::FromMoore(mooreMachine) : Transducer::FromMealy(mealyMachine));
+        }
         else if (mode == "trans")
         {
             if (isMoore)
@@ -72,7 +175,7 @@ int main()
                 isMoore = true;
             }
         }
-        cout << "Choose mode 'min' or 'trans': ";
+        cout << "Choose mode 'min', 'pmin', 'xmin', 'trans', 'hash', 'gen' or 'run': ";
         mode = ReadInput();
     } while (mode != "exit");    
 
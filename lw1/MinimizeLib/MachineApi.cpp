@@ -0,0 +1,323 @@
+﻿#include "MachineApi.h"
+#include "../Minimize/Machine.h"
+#include "../Minimize/Transducer.h"
+#include <charconv>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <stdexcept>
+
+using namespace std;
+
+struct MachineHandle
+{
+    MachineType type = MACHINE_MOORE;
+    Moore::Machine moore;
+    Mealy::Machine mealy;
+    // Таблица для исполнения строится при первом MachineRun
+    mutable once_flag transducerBuilt;
+    mutable optional<Transducer> transducer;
+
+    size_t GetStateCount() const
+    {
+        return type == MACHINE_MOORE ? moore.size() : mealy.size();
+    }
+
+    const Transducer& GetTransducer() const
+    {
+        call_once(transducerBuilt, [this] {
+            transducer.emplace(type == MACHINE_MOORE ? Transducer::FromMoore(moore) : Transducer::FromMealy(mealy));
+        });
+        return *transducer;
+    }
+};
+
+namespace
+{
+    const char SEPARATOR = ';';
+    const char MOORE_HEADER[] = "id;output;input;next_state";
+    const char MEALY_HEADER[] = "id;input;next_state;output";
+
+    // Пишет, пока хватает места, но считает весь размер
+    class BoundedWriter
+    {
+    public:
+        BoundedWriter(char* buffer, size_t capacity)
+            : m_buffer(buffer)
+            , m_capacity(capacity)
+        {
+        }
+
+        void Write(const char* data, size_t size)
+        {
+            for (size_t i = 0; i < size; i++, m_size++)
+            {
+                if (m_size < m_capacity)
+                {
+                    m_buffer[m_size] = data[i];
+                }
+            }
+        }
+
+        void Write(char symbol)
+        {
+            Write(&symbol, 1);
+        }
+
+        void WriteInt(int value)
+        {
+            char digits[16];
+            auto [end, error] = to_chars(digits, digits + sizeof(digits), value);
+            Write(digits, size_t(end - digits));
+        }
+
+        size_t GetSize() const
+        {
+            return m_size;
+        }
+
+    private:
+        char* m_buffer;
+        size_t m_capacity;
+        size_t m_size = 0;
+    };
+
+    // Строка с пустым символом и переходом в несуществующее состояние: при загрузке состояние
+    // появится, а переход отбросит канонизация
+    void WriteStateWithoutTransitions(BoundedWriter& writer, int id, optional<char> mooreOutput, size_t stateCount)
+    {
+        writer.WriteInt(id);
+        writer.Write(SEPARATOR);
+        if (mooreOutput)
+        {
+            writer.Write(*mooreOutput);
+            writer.Write(SEPARATOR);
+            writer.Write(SEPARATOR);
+            writer.WriteInt(int(stateCount));
+        }
+        else
+        {
+            writer.Write(SEPARATOR);
+            writer.WriteInt(int(stateCount));
+            writer.Write(SEPARATOR);
+        }
+        writer.Write('\n');
+    }
+
+    MachineHandle* CreateHandle(Moore::Machine machine)
+    {
+        auto handle = new MachineHandle;
+        handle->type = MACHINE_MOORE;
+        handle->moore = Moore::Canonicalize(machine);
+        return handle;
+    }
+
+    MachineHandle* CreateHandle(Mealy::Machine machine)
+    {
+        auto handle = new MachineHandle;
+        handle->type = MACHINE_MEALY;
+        handle->mealy = Mealy::Canonicalize(machine);
+        return handle;
+    }
+
+    template <class Fn>
+    MachineStatus Guard(Fn fn)
+    {
+        try
+        {
+            return fn();
+        }
+        catch (const bad_alloc&)
+        {
+            return MACHINE_OUT_OF_MEMORY;
+        }
+        catch (const length_error&)
+        {
+            return MACHINE_TOO_LARGE;
+        }
+        catch (...)
+        {
+            return MACHINE_INTERNAL_ERROR;
+        }
+    }
+}
+
+uint32_t MachineGetApiVersion(void)
+{
+    return MACHINE_API_VERSION;
+}
+
+const char* MachineGetStatusText(MachineStatus status)
+{
+    switch (status)
+    {
+    case MACHINE_OK:
+        return "OK";
+    case MACHINE_INVALID_ARGUMENT:
+        return "Invalid argument";
+    case MACHINE_PARSE_ERROR:
+        return "Malformed machine text";
+    case MACHINE_BUFFER_TOO_SMALL:
+        return "Buffer is too small";
+    case MACHINE_TOO_LARGE:
+        return "Machine is too large";
+    case MACHINE_OUT_OF_MEMORY:
+        return "Out of memory";
+    case MACHINE_INTERNAL_ERROR:
+        return "Internal error";
+    default:
+        return "Unknown status";
+    }
+}
+
+MachineStatus MachineLoad(const char* data, size_t size, MachineType type, MachineHandle** result)
+{
+    if ((data == nullptr && size > 0) || result == nullptr || (type != MACHINE_MOORE && type != MACHINE_MEALY))
+    {
+        return MACHINE_INVALID_ARGUMENT;
+    }
+    *result = nullptr;
+    return Guard([&] {
+        string_view text(data == nullptr ? "" : data, size);
+        try
+        {
+            *result = type == MACHINE_MOORE
+                ? CreateHandle(Moore::ReadFromMemory(text))
+                : CreateHandle(Mealy::ReadFromMemory(text));
+        }
+        // stoi сообщает о плохих номерах состояний через invalid_argument и out_of_range
+        catch (const invalid_argument&)
+        {
+            return MACHINE_PARSE_ERROR;
+        }
+        catch (const out_of_range&)
+        {
+            return MACHINE_PARSE_ERROR;
+        }
+        return MACHINE_OK;
+    });
+}
+
+MachineStatus MachineMinimize(const MachineHandle* machine, size_t threadCount, MachineHandle** result)
+{
+    if (machine == nullptr || result == nullptr)
+    {
+        return MACHINE_INVALID_ARGUMENT;
+    }
+    *result = nullptr;
+    return Guard([&] {
+        *result = machine->type == MACHINE_MOORE
+            ? CreateHandle(Moore::MinimizeParallel(machine->moore, threadCount))
+            : CreateHandle(Mealy::MinimizeParallel(machine->mealy, threadCount));
+        return MACHINE_OK;
+    });
+}
+
+MachineStatus MachineConvert(const MachineHandle* machine, MachineHandle** result)
+{
+    if (machine == nullptr || result == nullptr)
+    {
+        return MACHINE_INVALID_ARGUMENT;
+    }
+    *result = nullptr;
+    return Guard([&] {
+        *result = machine->type == MACHINE_MOORE
+            ? CreateHandle(Moore::ConvertToMealy(machine->moore))
+            : CreateHandle(Mealy::ConvertToMoore(machine->mealy));
+        return MACHINE_OK;
+    });
+}
+
+MachineStatus MachineRun(const MachineHandle* machine, int* state, const char* input, size_t size,
+    char* output, size_t threadCount, size_t* consumed)
+{
+    if (machine == nullptr || state == nullptr || consumed == nullptr
+        || (size > 0 && (input == nullptr || output == nullptr)))
+    {
+        return MACHINE_INVALID_ARGUMENT;
+    }
+    *consumed = 0;
+    return Guard([&] {
+        const Transducer& transducer = machine->GetTransducer();
+        if (*state < 0 || size_t(*state) >= transducer.GetStateCount())
+        {
+            return MACHINE_INVALID_ARGUMENT;
+        }
+        *consumed = transducer.RunParallel(*state, input, size, output, threadCount);
+        return MACHINE_OK;
+    });
+}
+
+MachineStatus MachineSerialize(const MachineHandle* machine, char* buffer, size_t capacity, size_t* size)
+{
+    if (machine == nullptr || size == nullptr || (buffer == nullptr && capacity > 0))
+    {
+        return MACHINE_INVALID_ARGUMENT;
+    }
+
+    BoundedWriter writer(buffer, capacity);
+    if (machine->type == MACHINE_MOORE)
+    {
+        writer.Write(MOORE_HEADER, sizeof(MOORE_HEADER) - 1);
+        writer.Write('\n');
+        for (const auto& state : machine->moore)
+        {
+            if (state.transitions.empty())
+            {
+                WriteStateWithoutTransitions(writer, state.id, state.output, machine->moore.size());
+            }
+            for (const auto& [input, nextState] : state.transitions)
+            {
+                writer.WriteInt(state.id);
+                writer.Write(SEPARATOR);
+                writer.Write(state.output);
+                writer.Write(SEPARATOR);
+                writer.Write(input);
+                writer.Write(SEPARATOR);
+                writer.WriteInt(nextState);
+                writer.Write('\n');
+            }
+        }
+    }
+    else
+    {
+        writer.Write(MEALY_HEADER, sizeof(MEALY_HEADER) - 1);
+        writer.Write('\n');
+        for (const auto& state : machine->mealy)
+        {
+            if (state.transitions.empty())
+            {
+                WriteStateWithoutTransitions(writer, state.id, nullopt, machine->mealy.size());
+            }
+            for (const auto& [input, transition] : state.transitions)
+            {
+                writer.WriteInt(state.id);
+                writer.Write(SEPARATOR);
+                writer.Write(input);
+                writer.Write(SEPARATOR);
+                writer.WriteInt(transition.first);
+                writer.Write(SEPARATOR);
+                writer.Write(transition.second);
+                writer.Write('\n');
+            }
+        }
+    }
+
+    *size = writer.GetSize();
+    return *size <= capacity ? MACHINE_OK : MACHINE_BUFFER_TOO_SMALL;
+}
+
+MachineType MachineGetType(const MachineHandle* machine)
+{
+    return machine == nullptr ? MACHINE_MOORE : machine->type;
+}
+
+size_t MachineGetStateCount(const MachineHandle* machine)
+{
+    return machine == nullptr ? 0 : machine->GetStateCount();
+}
+
+void MachineFree(MachineHandle* machine)
+{
+    delete machine;
+}
@@ -0,0 +1,75 @@
+﻿#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+// C-интерфейс минимизации и исполнения автоматов Мура и Мили для встраивания в другие процессы.
+// Библиотека ничего не пишет в консоль и не запускает внешних программ. Автомат после создания
+// не меняется: все функции, кроме MachineFree, можно вызывать для одного автомата из многих потоков.
+// Исключения наружу не выходят, ошибки возвращаются кодом MachineStatus.
+
+// Меняется только при несовместимых изменениях функций ниже
+#define MACHINE_API_VERSION 1
+
+// Для сборки динамической библиотеки определяется MACHINE_API_SHARED (и MACHINE_API_EXPORTS при её сборке)
+#if defined(MACHINE_API_SHARED) && defined(_WIN32)
+#ifdef MACHINE_API_EXPORTS
+#define MACHINE_API __declspec(dllexport)
+#else
+#define MACHINE_API __declspec(dllimport)
+#endif
+#elif defined(MACHINE_API_SHARED)
+#define MACHINE_API __attribute__((visibility("default")))
+#else
+#define MACHINE_API
+#endif
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+typedef struct MachineHandle MachineHandle;
+
+typedef enum MachineType
+{
+    MACHINE_MOORE = 0,
+    MACHINE_MEALY = 1
+} MachineType;
+
+typedef enum MachineStatus
+{
+    MACHINE_OK = 0,
+    MACHINE_INVALID_ARGUMENT = 1,
+    MACHINE_PARSE_ERROR = 2,
+    MACHINE_BUFFER_TOO_SMALL = 3,
+    MACHINE_TOO_LARGE = 4,
+    MACHINE_OUT_OF_MEMORY = 5,
+    MACHINE_INTERNAL_ERROR = 6
+} MachineStatus;
+
+MACHINE_API uint32_t MachineGetApiVersion(void);
+// Строка статическая, освобождать не нужно
+MACHINE_API const char* MachineGetStatusText(MachineStatus status);
+
+// Текст в формате файлов Minimize: заголовок и по строке на переход
+// (Мур - id;output;input;next_state, Мили - id;input;next_state;output), буфер после возврата не нужен.
+// Автомат хранится канонически: только достижимые из 0 состояния, номера в порядке обхода в ширину.
+MACHINE_API MachineStatus MachineLoad(const char* data, size_t size, MachineType type, MachineHandle** result);
+// threadCount == 0 - по числу ядер
+MACHINE_API MachineStatus MachineMinimize(const MachineHandle* machine, size_t threadCount, MachineHandle** result);
+// Мур в Мили или Мили в Мур
+MACHINE_API MachineStatus MachineConvert(const MachineHandle* machine, MachineHandle** result);
+// Продолжает с состояния *state (начальное - 0), output должен вмещать size символов.
+// *consumed < size - из состояния *state нет перехода по input[*consumed].
+MACHINE_API MachineStatus MachineRun(const MachineHandle* machine, int* state, const char* input, size_t size,
+    char* output, size_t threadCount, size_t* consumed);
+// Текст в формате MachineLoad, без завершающего нуля. Если не помещается, возвращается
+// MACHINE_BUFFER_TOO_SMALL, а в *size - нужный размер; при capacity == 0 buffer может быть NULL.
+MACHINE_API MachineStatus MachineSerialize(const MachineHandle* machine, char* buffer, size_t capacity, size_t* size);
+MACHINE_API MachineType MachineGetType(const MachineHandle* machine);
+MACHINE_API size_t MachineGetStateCount(const MachineHandle* machine);
+MACHINE_API void MachineFree(MachineHandle* machine);
+
+#ifdef __cplusplus
+}
+#endif
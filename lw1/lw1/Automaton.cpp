@@ -1,4 +1,58 @@
 #include "Automaton.h"
+#include "MooreView.h"
+
+namespace
+{
+    //  :  (, ) ,   
+    template <class Transitions>
+    auto GetRow(const Transitions& transitions, const std::string& state)
+    {
+        auto begin = transitions.lower_bound({ state, std::string() });
+        auto end = begin;
+        while (end != transitions.end() && end->first.first == state)
+        {
+            ++end;
+        }
+        return std::make_pair(begin, end);
+    }
+
+    //        ,     .
+    //       .
+    template <class Transitions, class TargetOf>
+    std::vector<std::string> GetCanonicalOrder(const std::string& startState, const Transitions& transitions,
+        TargetOf targetOf, std::map<std::string, uint32_t>& numbers)
+    {
+        std::vector<std::string> order{ startState };
+        numbers = { { startState, 0 } };
+        for (size_t i = 0; i < order.size(); i++)
+        {
+            auto [begin, end] = GetRow(transitions, order[i]);
+            for (auto it = begin; it != end; ++it)
+            {
+                const std::string& target = targetOf(it->second);
+                if (numbers.emplace(target, uint32_t(order.size())).second)
+                {
+                    order.push_back(target);
+                }
+            }
+        }
+        return order;
+    }
+
+    void AppendStrings(std::vector<uint8_t>& bytes, const std::set<std::string>& values)
+    {
+        AppendUint32(bytes, uint32_t(values.size()));
+        for (const auto& value : values)
+        {
+            AppendString(bytes, value);
+        }
+    }
+}
+
+void MealyAutomaton::ToMoore(std::unique_ptr<Automaton>& ptr)
+{
+    ptr = MooreView(*this).Materialize();
+}
 
 void MealyAutomaton::Minimize()
 {
@@ -249,4 +303,54 @@ void MooreAutomaton::Minimize()
 
     *this = minimized;
     std::cout << "   ." << std::endl;
-}
\ No newline at end of file
+}
+
+Hash128 MealyAutomaton::GetContentHash() const
+{
+    std::map<std::string, uint32_t> numbers;
+    auto order = GetCanonicalOrder(startState, transitions, [](const StringPair& value) -> const std::string& {
+        return value.first;
+    }, numbers);
+
+    std::vector<uint8_t> bytes{ 'L' };
+    AppendStrings(bytes, inputSymbols);
+    AppendStrings(bytes, outputSymbols);
+    AppendUint32(bytes, uint32_t(order.size()));
+    for (const auto& state : order)
+    {
+        auto [begin, end] = GetRow(transitions, state);
+        AppendUint32(bytes, uint32_t(std::distance(begin, end)));
+        for (auto it = begin; it != end; ++it)
+        {
+            AppendString(bytes, it->first.second);
+            AppendUint32(bytes, numbers[it->second.first]);
+            AppendString(bytes, it->second.second);
+        }
+    }
+    return HashBytes(bytes);
+}
+
+Hash128 MooreAutomaton::GetContentHash() const
+{
+    std::map<std::string, uint32_t> numbers;
+    auto order = GetCanonicalOrder(startState, transitions, [](const std::string& value) -> const std::string& {
+        return value;
+    }, numbers);
+
+    std::vector<uint8_t> bytes{ 'M' };
+    AppendStrings(bytes, inputSymbols);
+    AppendUint32(bytes, uint32_t(order.size()));
+    for (const auto& state : order)
+    {
+        auto output = stateOutputs.find(state);
+        AppendString(bytes, output != stateOutputs.end() ? output->second : std::string());
+        auto [begin, end] = GetRow(transitions, state);
+        AppendUint32(bytes, uint32_t(std::distance(begin, end)));
+        for (auto it = begin; it != end; ++it)
+        {
+            AppendString(bytes, it->first.second);
+            AppendUint32(bytes, numbers[it->second]);
+        }
+    }
+    return HashBytes(bytes);
+}
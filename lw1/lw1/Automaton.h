@@ -5,7 +5,9 @@
 #include <memory>
 #include <set>
 #include <string>
+#include <sstream>
 #include <fstream>
+#include "../../common/ContentHash.h"
 
 class Automaton
 {
@@ -16,11 +18,12 @@ public:
     virtual void ToMoore(std::unique_ptr<Automaton>& ptr) = 0;
     virtual void Minimize() = 0;
     virtual std::string GetType() const = 0;
+    virtual std::unique_ptr<Automaton> Clone() const = 0;
+    //   :     ,   
+    virtual Hash128 GetContentHash() const = 0;
 };
 
-class MooreAutomaton : public Automaton
-{
-};
+class MooreAutomaton;
 
 class MealyAutomaton : public Automaton
 {
@@ -49,46 +52,7 @@ public:
         std::cout << "    ." << std::endl;
     }
 
-    void ToMoore(std::unique_ptr<Automaton>& ptr) override
-    {
-        auto moore = std::make_unique<MooreAutomaton>();
-
-        std::unordered_map<std::string, std::string> stateOutputMap;
-        int newStateCounter = 0;
-
-        moore->startState = this->startState + "_m0";
-        moore->states.insert(moore->startState);
-        moore->stateOutputs[moore->startState] = "O_" + this->startState;
-
-        for (const auto& [key, value] : transitions)
-        {
-            const std::string& currentState = key.first;
-            const std::string& output = value.second;
-
-            std::string newState;
-            std::string mapKey = currentState + "_" + output;
-
-            if (stateOutputMap.find(mapKey) == stateOutputMap.end())
-            {
-                newState = currentState + "_m" + std::to_string(newStateCounter++);
-                stateOutputMap[mapKey] = newState;
-                moore->states.insert(newState);
-                moore->stateOutputs[newState] = output;
-            }
-            else
-            {
-                newState = stateOutputMap[mapKey];
-            }
-
-            moore->transitions[{currentState, key.second}] = newState;
-        }
-
-        moore->inputSymbols = this->inputSymbols;
-
-        moore->startState = stateOutputMap[this->startState + "_" + ""];
-
-        ptr = std::move(moore);
-    }
+    void ToMoore(std::unique_ptr<Automaton>& ptr) override;
 
     void Minimize() override;
 
@@ -97,6 +61,13 @@ public:
         return "Mealy";
     }
 
+    std::unique_ptr<Automaton> Clone() const override
+    {
+        return std::make_unique<MealyAutomaton>(*this);
+    }
+
+    Hash128 GetContentHash() const override;
+
     bool LoadFromFile(std::ifstream& infile)
     {
         std::string line;
@@ -231,6 +202,13 @@ public:
         return "Moore";
     }
 
+    std::unique_ptr<Automaton> Clone() const override
+    {
+        return std::make_unique<MooreAutomaton>(*this);
+    }
+
+    Hash128 GetContentHash() const override;
+
     bool LoadFromFile(std::ifstream& infile)
     {
         std::string line;
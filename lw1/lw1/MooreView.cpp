@@ -0,0 +1,171 @@
+#include "MooreView.h"
+#include <algorithm>
+
+namespace
+{
+    bool IsSameState(const MooreView::State& a, const MooreView::State& b)
+    {
+        if (*a.mealyState != *b.mealyState)
+        {
+            return false;
+        }
+        if (a.output == nullptr || b.output == nullptr)
+        {
+            return a.output == b.output;
+        }
+        return *a.output == *b.output;
+    }
+
+    bool IsLessState(const MooreView::State& a, const MooreView::State& b)
+    {
+        if (*a.mealyState != *b.mealyState)
+        {
+            return *a.mealyState < *b.mealyState;
+        }
+        if (a.output == nullptr || b.output == nullptr)
+        {
+            return a.output == nullptr && b.output != nullptr;
+        }
+        return *a.output < *b.output;
+    }
+}
+
+MooreView::MooreView(const MealyAutomaton& mealy)
+    : m_mealy(mealy)
+{
+}
+
+MooreView::State MooreView::GetStartState() const
+{
+    return { &m_mealy.startState, nullptr };
+}
+
+std::optional<MooreView::State> MooreView::GetNextState(const State& state, const std::string& input) const
+{
+    auto it = m_mealy.transitions.find({ *state.mealyState, input });
+    if (it == m_mealy.transitions.end())
+    {
+        return std::nullopt;
+    }
+    return State{ &it->second.first, &it->second.second };
+}
+
+const std::string& MooreView::GetOutput(const State& state) const
+{
+    return state.output != nullptr ? *state.output : START_OUTPUT;
+}
+
+std::string MooreView::GetName(const State& state) const
+{
+    if (state.output == nullptr)
+    {
+        return *state.mealyState;
+    }
+    return *state.mealyState + "_" + *state.output;
+}
+
+std::vector<MooreView::State>::const_iterator MooreView::begin() const
+{
+    return GetStates().begin();
+}
+
+std::vector<MooreView::State>::const_iterator MooreView::end() const
+{
+    return GetStates().end();
+}
+
+size_t MooreView::GetStateCount() const
+{
+    return GetStates().size();
+}
+
+const std::vector<MooreView::State>& MooreView::GetStates() const
+{
+    if (m_indexed)
+    {
+        return m_states;
+    }
+
+    m_states.reserve(m_mealy.transitions.size() + 1);
+    m_states.push_back(GetStartState());
+    for (const auto& [key, value] : m_mealy.transitions)
+    {
+        m_states.push_back({ &value.first, &value.second });
+    }
+
+    std::sort(m_states.begin() + 1, m_states.end(), IsLessState);
+    m_states.erase(std::unique(m_states.begin() + 1, m_states.end(), IsSameState), m_states.end());
+    m_states.shrink_to_fit();
+    m_indexed = true;
+
+    return m_states;
+}
+
+void MooreView::Print() const
+{
+    std::cout << "  (  )" << std::endl;
+    std::cout << ": ";
+    for (const auto& state : *this) std::cout << GetName(state) << " ";
+    std::cout << std::endl << " : ";
+    for (const auto& sym : m_mealy.inputSymbols) std::cout << sym << " ";
+    std::cout << std::endl << " :" << std::endl;
+    for (const auto& state : *this)
+    {
+        std::cout << GetName(state) << " : " << GetOutput(state) << std::endl;
+    }
+    std::cout << " : " << GetName(GetStartState()) << std::endl;
+    std::cout << ":" << std::endl;
+    for (const auto& state : *this)
+    {
+        for (const auto& input : m_mealy.inputSymbols)
+        {
+            auto next = GetNextState(state, input);
+            if (next)
+            {
+                std::cout << GetName(state) << " --" << input << "--> " << GetName(*next) << std::endl;
+            }
+        }
+    }
+}
+
+bool MooreView::Run(const std::vector<std::string>& inputs, std::vector<std::string>& outputs) const
+{
+    State current = GetStartState();
+    for (const auto& input : inputs)
+    {
+        auto next = GetNextState(current, input);
+        if (!next)
+        {
+            return false;
+        }
+        current = *next;
+        outputs.push_back(GetOutput(current));
+    }
+    return true;
+}
+
+std::unique_ptr<MooreAutomaton> MooreView::Materialize() const
+{
+    auto moore = std::make_unique<MooreAutomaton>();
+
+    moore->inputSymbols = m_mealy.inputSymbols;
+    moore->startState = GetName(GetStartState());
+
+    for (const auto& state : *this)
+    {
+        std::string name = GetName(state);
+        moore->states.insert(name);
+        moore->stateOutputs[name] = GetOutput(state);
+
+        for (const auto& input : m_mealy.inputSymbols)
+        {
+            auto next = GetNextState(state, input);
+            if (next)
+            {
+                moore->transitions[{ name, input }] = GetName(*next);
+            }
+        }
+    }
+
+    return moore;
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+#include "Automaton.h"
+
+//  ,        .
+//   -  ( ,      ).
+class MooreView
+{
+public:
+    struct State
+    {
+        const std::string* mealyState;
+        // nullptr   ,     
+        const std::string* output;
+    };
+
+    static inline const std::string START_OUTPUT = "-";
+
+    explicit MooreView(const MealyAutomaton& mealy);
+
+    State GetStartState() const;
+    std::optional<State> GetNextState(const State& state, const std::string& input) const;
+    const std::string& GetOutput(const State& state) const;
+    std::string GetName(const State& state) const;
+
+    std::vector<State>::const_iterator begin() const;
+    std::vector<State>::const_iterator end() const;
+    size_t GetStateCount() const;
+
+    void Print() const;
+    bool Run(const std::vector<std::string>& inputs, std::vector<std::string>& outputs) const;
+    std::unique_ptr<MooreAutomaton> Materialize() const;
+
+private:
+    const std::vector<State>& GetStates() const;
+
+    const MealyAutomaton& m_mealy;
+    //       
+    mutable std::vector<State> m_states;
+    mutable bool m_indexed = false;
+};
@@ -0,0 +1,44 @@
+#include "ResultCache.h"
+
+ResultCache::ResultCache(size_t capacity)
+    : m_capacity(capacity)
+{
+}
+
+std::unique_ptr<Automaton> ResultCache::Find(const std::string& operation, const Hash128& source)
+{
+    auto it = m_index.find(GetKey(operation, source));
+    if (it == m_index.end())
+    {
+        return nullptr;
+    }
+    m_entries.splice(m_entries.begin(), m_entries, it->second);
+    return it->second->result->Clone();
+}
+
+void ResultCache::Store(const std::string& operation, const Hash128& source, const Automaton& result)
+{
+    if (m_capacity == 0)
+    {
+        return;
+    }
+    std::string key = GetKey(operation, source);
+    auto it = m_index.find(key);
+    if (it != m_index.end())
+    {
+        m_entries.splice(m_entries.begin(), m_entries, it->second);
+        return;
+    }
+    if (m_entries.size() == m_capacity)
+    {
+        m_index.erase(m_entries.back().key);
+        m_entries.pop_back();
+    }
+    m_entries.push_front(Entry{ key, result.Clone() });
+    m_index.emplace(std::move(key), m_entries.begin());
+}
+
+std::string ResultCache::GetKey(const std::string& operation, const Hash128& source)
+{
+    return operation + ':' + source.ToString();
+}
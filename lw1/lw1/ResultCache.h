@@ -0,0 +1,33 @@
+#pragma once
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include "Automaton.h"
+
+//          .
+//    ;       .
+class ResultCache
+{
+public:
+    static const size_t DEFAULT_CAPACITY = 32;
+
+    explicit ResultCache(size_t capacity = DEFAULT_CAPACITY);
+
+    std::unique_ptr<Automaton> Find(const std::string& operation, const Hash128& source);
+    void Store(const std::string& operation, const Hash128& source, const Automaton& result);
+
+private:
+    struct Entry
+    {
+        std::string key;
+        std::unique_ptr<Automaton> result;
+    };
+
+    static std::string GetKey(const std::string& operation, const Hash128& source);
+
+    size_t m_capacity;
+    //     
+    std::list<Entry> m_entries;
+    std::unordered_map<std::string, std::list<Entry>::iterator> m_index;
+};
@@ -1,7 +1,10 @@
 ﻿#include <fstream>
 #include <vector>
 #include <sstream>
+#include <limits>
 #include "Automaton.h"
+#include "MooreView.h"
+#include "ResultCache.h"
 
 using namespace std;
 
@@ -19,6 +22,8 @@ void PrintStartupData()
         << "print" << endl
         << "toMealy" << endl
         << "toMoore" << endl
+        << "viewMoore" << endl
+        << "runMoore <inputSymbols...>" << endl
         << "minimize" << endl
         << "Введите команду: " << endl;
 }
@@ -79,7 +84,23 @@ void HandleRead(const string& filename, unique_ptr<Automaton>& currentAutomaton)
     }
 }
 
-void HandleToMealy(unique_ptr<Automaton>& currentAutomaton)
+// Выполняет операцию над текущим автоматом или берёт её результат из кэша
+template <class Operation>
+void RunCached(const string& name, unique_ptr<Automaton>& currentAutomaton, ResultCache& cache, Operation&& operation)
+{
+    const Hash128 source = currentAutomaton->GetContentHash();
+    if (auto cached = cache.Find(name, source))
+    {
+        currentAutomaton = move(cached);
+        cout << "Результат взят из кэша." << endl;
+        return;
+    }
+
+    operation();
+    cache.Store(name, source, *currentAutomaton);
+}
+
+void HandleToMealy(unique_ptr<Automaton>& currentAutomaton, ResultCache& cache)
 {
     if (!currentAutomaton)
     {
@@ -91,11 +112,11 @@ void HandleToMealy(unique_ptr<Automaton>& currentAutomaton)
         cout << "Автомат уже является автоматом Мили." << endl;
     }
     else {
-        currentAutomaton->ToMealy(currentAutomaton);
+        RunCached("toMealy", currentAutomaton, cache, [&] { currentAutomaton->ToMealy(currentAutomaton); });
     }
 }
 
-void HandleToMoore(unique_ptr<Automaton>& currentAutomaton)
+void HandleToMoore(unique_ptr<Automaton>& currentAutomaton, ResultCache& cache)
 {
     if (!currentAutomaton)
     {
@@ -108,11 +129,63 @@ void HandleToMoore(unique_ptr<Automaton>& currentAutomaton)
         cout << "Автомат уже является автоматом Мура.\n";
     }
     else {
-        currentAutomaton->ToMoore(currentAutomaton);
+        RunCached("toMoore", currentAutomaton, cache, [&] { currentAutomaton->ToMoore(currentAutomaton); });
+    }
+}
+
+const MealyAutomaton* GetMealy(const unique_ptr<Automaton>& currentAutomaton)
+{
+    if (!currentAutomaton)
+    {
+        cout << "Автомат не загружен.\n";
+        return nullptr;
+    }
+
+    auto mealy = dynamic_cast<const MealyAutomaton*>(currentAutomaton.get());
+    if (!mealy)
+    {
+        cout << "Команда доступна только для автомата Мили.\n";
+    }
+    return mealy;
+}
+
+void HandleViewMoore(const unique_ptr<Automaton>& currentAutomaton)
+{
+    if (auto mealy = GetMealy(currentAutomaton))
+    {
+        MooreView(*mealy).Print();
+    }
+}
+
+void HandleRunMoore(istringstream& iss, const unique_ptr<Automaton>& currentAutomaton)
+{
+    auto mealy = GetMealy(currentAutomaton);
+    if (!mealy)
+    {
+        return;
+    }
+
+    vector<string> inputs;
+    string input;
+    while (iss >> input)
+    {
+        inputs.push_back(input);
+    }
+
+    vector<string> outputs;
+    bool completed = MooreView(*mealy).Run(inputs, outputs);
+    for (const auto& output : outputs)
+    {
+        cout << output << " ";
+    }
+    cout << endl;
+    if (!completed)
+    {
+        cout << "Нет перехода по символу " << inputs[outputs.size()] << "." << endl;
     }
 }
 
-void HandleMinimize(unique_ptr<Automaton>& currentAutomaton)
+void HandleMinimize(unique_ptr<Automaton>& currentAutomaton, ResultCache& cache)
 {
     if (!currentAutomaton)
     {
@@ -120,7 +193,7 @@ void HandleMinimize(unique_ptr<Automaton>& currentAutomaton)
         return;
     }
 
-    currentAutomaton->Minimize();
+    RunCached("minimize", currentAutomaton, cache, [&] { currentAutomaton->Minimize(); });
 }
 
 void HandlePrint(const unique_ptr<Automaton>& currentAutomaton)
@@ -134,7 +207,7 @@ void HandlePrint(const unique_ptr<Automaton>& currentAutomaton)
     currentAutomaton->Print();
 }
 
-bool HandleCommand(const string& command, unique_ptr<Automaton>& currentAutomaton) {
+bool HandleCommand(const string& command, unique_ptr<Automaton>& currentAutomaton, ResultCache& cache) {
     istringstream iss(command);
     string cmd;
     iss >> cmd;
@@ -158,15 +231,23 @@ bool HandleCommand(const string& command, unique_ptr<Automaton>& currentAutomato
     }
     else if (cmd == "toMealy")
     {
-        HandleToMealy(currentAutomaton);
+        HandleToMealy(currentAutomaton, cache);
     }
     else if (cmd == "toMoore")
     {
-        HandleToMoore(currentAutomaton);
+        HandleToMoore(currentAutomaton, cache);
+    }
+    else if (cmd == "viewMoore")
+    {
+        HandleViewMoore(currentAutomaton);
+    }
+    else if (cmd == "runMoore")
+    {
+        HandleRunMoore(iss, currentAutomaton);
     }
     else if (cmd == "minimize")
     {
-        HandleMinimize(currentAutomaton);
+        HandleMinimize(currentAutomaton, cache);
     }
     else if (cmd == "print")
     {
@@ -180,16 +261,58 @@ bool HandleCommand(const string& command, unique_ptr<Automaton>& currentAutomato
     return true;
 }
 
-int main() {
+// Команды читаются из файла или stdin ("-") без приглашений, до exit или конца ввода
+int RunScript(istream& input)
+{
     unique_ptr<Automaton> currentAutomaton = nullptr;
+    ResultCache cache;
+    string command;
+
+    while (getline(input, command))
+    {
+        if (command.empty() || command[0] == '#')
+        {
+            continue;
+        }
+        if (!HandleCommand(command, currentAutomaton, cache))
+        {
+            break;
+        }
+    }
+
+    return EndCode::Success;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 1)
+    {
+        string scriptName = argv[1];
+        if (scriptName == "-")
+        {
+            return RunScript(cin);
+        }
+
+        ifstream script(scriptName);
+        if (!script)
+        {
+            cout << "Не удалось открыть файл: " << scriptName << endl;
+            return EndCode::Error;
+        }
+        return RunScript(script);
+    }
+
+    unique_ptr<Automaton> currentAutomaton = nullptr;
+    ResultCache cache;
     string input;
 
    
     while (true) {
         cout << "> ";
-        getline(cin, input);
+        if (!getline(cin, input)) {
+            break;
+        }
 
-        if (!HandleCommand(input, currentAutomaton)) {
+        if (!HandleCommand(input, currentAutomaton, cache)) {
             break;
         }
     }
@@ -0,0 +1,285 @@
+﻿#include "BitParallelNfa.h"
+#include <algorithm>
+#include <bit>
+#include <map>
+#include <string>
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define BIT_PARALLEL_SSE2
+#endif
+
+using namespace std;
+
+namespace
+{
+    using Automata::Nfa;
+
+    // Таблицы по байтам маски строятся, только если укладываются в этот объём
+    const size_t MAX_CHUNK_TABLE_BYTES = size_t(8) << 20;
+
+    // Переходы каждого состояния с учётом эпсилон-замыкания
+    void RemoveEpsilon(const Nfa& nfa, vector<vector<Nfa::Edge>>& edges, vector<char>& accepting)
+    {
+        const int stateCount = int(nfa.GetStateCount());
+        edges.assign(stateCount, {});
+        accepting.assign(stateCount, false);
+
+        vector<int> marks(stateCount, -1);
+        vector<int> stack;
+        for (int state = 0; state < stateCount; state++)
+        {
+            stack.assign(1, state);
+            marks[state] = state;
+            while (!stack.empty())
+            {
+                int current = stack.back();
+                stack.pop_back();
+                accepting[state] = accepting[state] || nfa.IsAccepting(current);
+                const auto& currentEdges = nfa.GetEdges(current);
+                edges[state].insert(edges[state].end(), currentEdges.begin(), currentEdges.end());
+                for (int target : nfa.GetEpsilonEdges(current))
+                {
+                    if (marks[target] != state)
+                    {
+                        marks[target] = state;
+                        stack.push_back(target);
+                    }
+                }
+            }
+        }
+    }
+
+    void OrInto(uint64_t* to, const uint64_t* from, size_t wordCount)
+    {
+        size_t i = 0;
+#ifdef BIT_PARALLEL_SSE2
+        for (; i + 2 <= wordCount; i += 2)
+        {
+            __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(to + i));
+            __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(from + i));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(to + i), _mm_or_si128(a, b));
+        }
+#endif
+        for (; i < wordCount; i++)
+        {
+            to[i] |= from[i];
+        }
+    }
+
+    void AndInto(uint64_t* to, const uint64_t* from, size_t wordCount)
+    {
+        size_t i = 0;
+#ifdef BIT_PARALLEL_SSE2
+        for (; i + 2 <= wordCount; i += 2)
+        {
+            __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(to + i));
+            __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(from + i));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(to + i), _mm_and_si128(a, b));
+        }
+#endif
+        for (; i < wordCount; i++)
+        {
+            to[i] &= from[i];
+        }
+    }
+}
+
+namespace Automata
+{
+    BitParallelNfa::BitParallelNfa(const Nfa& nfa)
+    {
+        vector<vector<Nfa::Edge>> edges;
+        vector<char> accepting;
+        RemoveEpsilon(nfa, edges, accepting);
+
+        // Однородный автомат: состояние 0 - начальное, остальные - пары (состояние NFA, входящий символ)
+        map<pair<int, char>, int> splitIds;
+        vector<pair<int, char>> splitStates{ { nfa.GetStart(), 0 } };
+        auto getSplit = [&](int state, char symbol) {
+            auto [it, added] = splitIds.emplace(make_pair(state, symbol), int(splitStates.size()));
+            if (added)
+            {
+                splitStates.emplace_back(state, symbol);
+            }
+            return it->second;
+        };
+
+        vector<vector<int>> follow;
+        vector<char> symbols{ 0 };
+        vector<char> splitAccepting;
+        for (size_t i = 0; i < splitStates.size() && nfa.GetStateCount() > 0; i++)
+        {
+            int state = splitStates[i].first;
+            follow.emplace_back();
+            for (const auto& edge : edges[state])
+            {
+                follow[i].push_back(getSplit(edge.target, edge.symbol));
+            }
+            splitAccepting.push_back(accepting[state]);
+            if (i > 0)
+            {
+                symbols.push_back(splitStates[i].second);
+            }
+        }
+        Build(follow, symbols, splitAccepting);
+    }
+
+    size_t BitParallelNfa::GetStateCount() const
+    {
+        return m_stateCount;
+    }
+
+    size_t BitParallelNfa::GetWordCount() const
+    {
+        return m_wordCount;
+    }
+
+    bool BitParallelNfa::Accepts(string_view input) const
+    {
+        if (m_stateCount == 0)
+        {
+            return false;
+        }
+
+        Mask current = m_start, next(m_wordCount);
+        for (char symbol : input)
+        {
+            Step(current.data(), next.data(), static_cast<unsigned char>(symbol));
+            if (IsEmpty(next.data()))
+            {
+                return false;
+            }
+            current.swap(next);
+        }
+        return HasAccepting(current.data());
+    }
+
+    size_t BitParallelNfa::Search(string_view input) const
+    {
+        if (m_stateCount == 0)
+        {
+            return string_view::npos;
+        }
+        if (HasAccepting(m_start.data()))
+        {
+            return 0;
+        }
+
+        // Начальное состояние остаётся активным на каждом шаге
+        Mask current = m_start, next(m_wordCount);
+        for (size_t i = 0; i < input.size(); i++)
+        {
+            Step(current.data(), next.data(), static_cast<unsigned char>(input[i]));
+            if (HasAccepting(next.data()))
+            {
+                return i + 1;
+            }
+            current.swap(next);
+            current[0] |= 1;
+        }
+        return string_view::npos;
+    }
+
+    void BitParallelNfa::Build(const vector<vector<int>>& follow, const vector<char>& symbols, const vector<char>& accepting)
+    {
+        m_stateCount = follow.size();
+        m_wordCount = max<size_t>((m_stateCount + 63) / 64, 1);
+        m_accepting.assign(m_wordCount, 0);
+        m_start.assign(m_wordCount, 0);
+        m_symbolMasks.assign(256 * m_wordCount, 0);
+        m_start[0] = 1;
+
+        m_stateFollow.assign(m_stateCount * m_wordCount, 0);
+        for (size_t state = 0; state < m_stateCount; state++)
+        {
+            const uint64_t bit = uint64_t(1) << (state % 64);
+            if (accepting[state])
+            {
+                m_accepting[state / 64] |= bit;
+            }
+            if (state > 0)
+            {
+                m_symbolMasks[static_cast<unsigned char>(symbols[state]) * m_wordCount + state / 64] |= bit;
+            }
+            for (int target : follow[state])
+            {
+                m_stateFollow[state * m_wordCount + target / 64] |= uint64_t(1) << (target % 64);
+            }
+        }
+
+        // Таблица на каждый байт маски: объединение Follow по всем установленным битам байта
+        const size_t chunkCount = (m_stateCount + 7) / 8;
+        if (chunkCount * 256 * m_wordCount * sizeof(uint64_t) > MAX_CHUNK_TABLE_BYTES)
+        {
+            m_follow.clear();
+            return;
+        }
+        m_follow.assign(chunkCount * 256 * m_wordCount, 0);
+        for (size_t chunk = 0; chunk < chunkCount; chunk++)
+        {
+            for (size_t value = 1; value < 256; value++)
+            {
+                uint64_t* row = &m_follow[(chunk * 256 + value) * m_wordCount];
+                size_t lowBit = value & (0 - value);
+                size_t state = chunk * 8 + countr_zero(value);
+                if (value != lowBit)
+                {
+                    const uint64_t* rest = &m_follow[(chunk * 256 + (value ^ lowBit)) * m_wordCount];
+                    copy(rest, rest + m_wordCount, row);
+                }
+                if (state < m_stateCount)
+                {
+                    OrInto(row, &m_stateFollow[state * m_wordCount], m_wordCount);
+                }
+            }
+        }
+    }
+
+    void BitParallelNfa::Step(const uint64_t* current, uint64_t* next, unsigned char symbol) const
+    {
+        fill(next, next + m_wordCount, 0);
+        if (m_follow.empty())
+        {
+            for (size_t word = 0; word < m_wordCount; word++)
+            {
+                for (uint64_t bits = current[word]; bits != 0; bits &= bits - 1)
+                {
+                    size_t state = word * 64 + countr_zero(bits);
+                    OrInto(next, &m_stateFollow[state * m_wordCount], m_wordCount);
+                }
+            }
+        }
+        else
+        {
+            const size_t chunkCount = (m_stateCount + 7) / 8;
+            for (size_t chunk = 0; chunk < chunkCount; chunk++)
+            {
+                size_t value = (current[chunk / 8] >> (8 * (chunk % 8))) & 0xff;
+                if (value != 0)
+                {
+                    OrInto(next, &m_follow[(chunk * 256 + value) * m_wordCount], m_wordCount);
+                }
+            }
+        }
+        AndInto(next, &m_symbolMasks[symbol * m_wordCount], m_wordCount);
+    }
+
+    bool BitParallelNfa::HasAccepting(const uint64_t* mask) const
+    {
+        for (size_t i = 0; i < m_wordCount; i++)
+        {
+            if (mask[i] & m_accepting[i])
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool BitParallelNfa::IsEmpty(const uint64_t* mask) const
+    {
+        return all_of(mask, mask + m_wordCount, [](uint64_t word) {
+            return word == 0;
+        });
+    }
+}
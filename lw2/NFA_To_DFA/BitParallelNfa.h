@@ -0,0 +1,44 @@
+﻿#pragma once
+#include <cstdint>
+#include <string_view>
+#include <vector>
+#include "Nfa.h"
+
+namespace Automata
+{
+    // Моделирование NFA без детерминизации: множество активных состояний - битовая маска
+    // из GetWordCount() слов, шаг по символу c - D' = Follow(D) & B[c].
+    // Эпсилон-переходы снимаются при построении, затем каждое состояние расщепляется по символу
+    // входящих переходов, чтобы все переходы в состояние были помечены одним символом.
+    class BitParallelNfa
+    {
+    public:
+        explicit BitParallelNfa(const Nfa& nfa);
+
+        size_t GetStateCount() const;
+        size_t GetWordCount() const;
+
+        bool Accepts(std::string_view input) const;
+        // Конец первого вхождения в любом месте строки или npos
+        size_t Search(std::string_view input) const;
+
+    private:
+        using Mask = std::vector<uint64_t>;
+
+        void Build(const std::vector<std::vector<int>>& follow, const std::vector<char>& symbols, const std::vector<char>& accepting);
+        void Step(const uint64_t* current, uint64_t* next, unsigned char symbol) const;
+        bool HasAccepting(const uint64_t* mask) const;
+        bool IsEmpty(const uint64_t* mask) const;
+
+        size_t m_stateCount = 0;
+        size_t m_wordCount = 0;
+        // Follow каждого состояния: m_stateFollow[state * m_wordCount]
+        std::vector<uint64_t> m_stateFollow;
+        // Follow по байтам маски: m_follow[(chunk * 256 + value) * m_wordCount], пусто для больших автоматов
+        std::vector<uint64_t> m_follow;
+        // B[c]: состояния, в которые входят переходы по c
+        std::vector<uint64_t> m_symbolMasks;
+        Mask m_accepting;
+        Mask m_start;
+    };
+}
@@ -0,0 +1,150 @@
+﻿#include "CombDfa.h"
+#include <algorithm>
+#include <map>
+
+using namespace std;
+
+namespace Automata
+{
+    CombDfa::CombDfa(const Dfa& dfa)
+    {
+        for (int byte = 0; byte < 256; byte++)
+        {
+            int symbolIndex = dfa.GetSymbolIndex(char(byte));
+            m_byteClass[byte] = symbolIndex < 0 ? -1 : dfa.GetSymbolClass(symbolIndex);
+        }
+
+        const size_t stateCount = dfa.GetStateCount();
+        const size_t classCount = dfa.GetClassCount();
+        m_base.assign(stateCount, 0);
+        m_default.assign(stateCount, NO_STATE);
+        m_accepting.resize(stateCount);
+
+        // Переход по умолчанию - самый частый в строке, остальные классы попадают в таблицу
+        vector<vector<int>> rows(stateCount);
+        map<int, size_t> frequency;
+        for (size_t state = 0; state < stateCount; state++)
+        {
+            m_accepting[state] = dfa.IsAccepting(int(state));
+            frequency.clear();
+            for (size_t symbolClass = 0; symbolClass < classCount; symbolClass++)
+            {
+                frequency[dfa.GetNextStateByClass(int(state), symbolClass)]++;
+            }
+            m_default[state] = max_element(frequency.begin(), frequency.end(), [](const auto& a, const auto& b) {
+                return a.second < b.second;
+            })->first;
+            for (size_t symbolClass = 0; symbolClass < classCount; symbolClass++)
+            {
+                if (dfa.GetNextStateByClass(int(state), symbolClass) != m_default[state])
+                {
+                    rows[state].push_back(int(symbolClass));
+                }
+            }
+        }
+
+        // Первая подходящая позиция, длинные строки раскладываются первыми
+        vector<int> order(stateCount);
+        for (size_t state = 0; state < stateCount; state++)
+        {
+            order[state] = int(state);
+        }
+        stable_sort(order.begin(), order.end(), [&rows](int a, int b) {
+            return rows[a].size() > rows[b].size();
+        });
+
+        size_t firstFree = 0;
+        for (int state : order)
+        {
+            const auto& row = rows[state];
+            if (row.empty())
+            {
+                break;
+            }
+
+            size_t base = firstFree > size_t(row.front()) ? firstFree - row.front() : 0;
+            for (;; base++)
+            {
+                bool fits = all_of(row.begin(), row.end(), [&](int symbolClass) {
+                    return base + symbolClass >= m_entries.size() || m_entries[base + symbolClass].check == NO_STATE;
+                });
+                if (fits)
+                {
+                    break;
+                }
+            }
+
+            if (m_entries.size() < base + classCount)
+            {
+                m_entries.resize(base + classCount, { NO_STATE, NO_STATE });
+            }
+            for (int symbolClass : row)
+            {
+                m_entries[base + symbolClass] = { dfa.GetNextStateByClass(state, symbolClass), state };
+            }
+            m_base[state] = int(base);
+            while (firstFree < m_entries.size() && m_entries[firstFree].check != NO_STATE)
+            {
+                firstFree++;
+            }
+        }
+
+        // Строки без ячеек смотрят в начало таблицы, где check не совпадёт с их номером
+        if (m_entries.size() < classCount)
+        {
+            m_entries.resize(classCount, { NO_STATE, NO_STATE });
+        }
+        m_entries.shrink_to_fit();
+    }
+
+    int CombDfa::GetNextState(int state, char symbol) const
+    {
+        const int symbolClass = m_byteClass[static_cast<unsigned char>(symbol)];
+        if (symbolClass < 0)
+        {
+            return NO_STATE;
+        }
+        const Entry& entry = m_entries[size_t(m_base[state]) + symbolClass];
+        return entry.check == state ? entry.next : m_default[state];
+    }
+
+    bool CombDfa::IsAccepting(int state) const
+    {
+        return m_accepting[state];
+    }
+
+    bool CombDfa::Accepts(string_view input) const
+    {
+        if (m_accepting.empty())
+        {
+            return false;
+        }
+
+        int state = 0;
+        for (char symbol : input)
+        {
+            state = GetNextState(state, symbol);
+            if (state == NO_STATE)
+            {
+                return false;
+            }
+        }
+        return m_accepting[state];
+    }
+
+    size_t CombDfa::GetStateCount() const
+    {
+        return m_accepting.size();
+    }
+
+    size_t CombDfa::GetEntryCount() const
+    {
+        return m_entries.size();
+    }
+
+    size_t CombDfa::GetMemoryUsage() const
+    {
+        return sizeof(m_byteClass) + (m_base.size() + m_default.size()) * sizeof(int)
+            + m_entries.size() * sizeof(Entry) + m_accepting.size();
+    }
+}
@@ -0,0 +1,40 @@
+﻿#pragma once
+#include <array>
+#include <string_view>
+#include <vector>
+#include "Dfa.h"
+
+namespace Automata
+{
+    // Сжатая таблица переходов со смещением строк (base/next/check) и переходом по умолчанию.
+    // Строка состояния хранит только классы, переход по которым отличается от default[state];
+    // строки накладываются друг на друга со сдвигом base[state], check указывает владельца ячейки:
+    //   i = base[state] + class; check[i] == state ? next[i] : default[state]
+    class CombDfa
+    {
+    public:
+        explicit CombDfa(const Dfa& dfa);
+
+        int GetNextState(int state, char symbol) const;
+        bool IsAccepting(int state) const;
+        bool Accepts(std::string_view input) const;
+
+        size_t GetStateCount() const;
+        // Ячейки next/check, включая незанятые промежутки между строками
+        size_t GetEntryCount() const;
+        size_t GetMemoryUsage() const;
+
+    private:
+        struct Entry
+        {
+            int next;
+            int check;
+        };
+
+        std::array<int, 256> m_byteClass;
+        std::vector<int> m_base;
+        std::vector<int> m_default;
+        std::vector<Entry> m_entries;
+        std::vector<char> m_accepting;
+    };
+}
@@ -0,0 +1,158 @@
+﻿#include "CsrNfa.h"
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+using namespace std;
+
+namespace Automata
+{
+    CsrNfa::CsrNfa(const Nfa& nfa)
+        : m_start(nfa.GetStart())
+    {
+        const size_t stateCount = nfa.GetStateCount();
+        m_accepting.resize(stateCount);
+        m_runOffsets.reserve(stateCount + 1);
+        m_runOffsets.push_back(0);
+        m_epsilonOffsets.reserve(stateCount + 1);
+        m_epsilonOffsets.push_back(0);
+        m_runStarts.push_back(0);
+
+        bool used[256] = {};
+        vector<pair<unsigned char, int>> edges;
+        for (size_t state = 0; state < stateCount; state++)
+        {
+            m_accepting[state] = nfa.IsAccepting(int(state));
+
+            edges.clear();
+            for (const auto& edge : nfa.GetEdges(int(state)))
+            {
+                edges.emplace_back(static_cast<unsigned char>(edge.symbol), edge.target);
+            }
+            sort(edges.begin(), edges.end());
+            edges.erase(unique(edges.begin(), edges.end()), edges.end());
+            for (size_t i = 0; i < edges.size(); i++)
+            {
+                if (i == 0 || edges[i].first != edges[i - 1].first)
+                {
+                    if (i > 0)
+                    {
+                        m_runStarts.push_back(uint32_t(m_targets.size()));
+                    }
+                    m_runSymbols.push_back(char(edges[i].first));
+                    used[edges[i].first] = true;
+                }
+                m_targets.push_back(edges[i].second);
+            }
+            if (!edges.empty())
+            {
+                m_runStarts.push_back(uint32_t(m_targets.size()));
+            }
+            m_runOffsets.push_back(uint32_t(m_runSymbols.size()));
+
+            const auto& epsilonEdges = nfa.GetEpsilonEdges(int(state));
+            m_epsilonTargets.insert(m_epsilonTargets.end(), epsilonEdges.begin(), epsilonEdges.end());
+            m_epsilonOffsets.push_back(uint32_t(m_epsilonTargets.size()));
+        }
+        if (m_targets.size() > UINT32_MAX || m_epsilonTargets.size() > UINT32_MAX)
+        {
+            throw length_error("NFA has too many transitions");
+        }
+
+        for (int symbol = 0; symbol < 256; symbol++)
+        {
+            if (used[symbol])
+            {
+                m_alphabet.push_back(char(symbol));
+            }
+        }
+        sort(m_alphabet.begin(), m_alphabet.end());
+    }
+
+    size_t CsrNfa::GetStateCount() const
+    {
+        return m_accepting.size();
+    }
+
+    int CsrNfa::GetStart() const
+    {
+        return m_start;
+    }
+
+    bool CsrNfa::IsAccepting(int state) const
+    {
+        return m_accepting[state];
+    }
+
+    bool CsrNfa::HasEpsilon() const
+    {
+        return !m_epsilonTargets.empty();
+    }
+
+    size_t CsrNfa::GetEdgeCount() const
+    {
+        return m_targets.size();
+    }
+
+    const vector<char>& CsrNfa::GetAlphabet() const
+    {
+        return m_alphabet;
+    }
+
+    span<const int> CsrNfa::GetTargets(int state, char symbol) const
+    {
+        auto begin = m_runSymbols.begin() + m_runOffsets[state];
+        auto end = m_runSymbols.begin() + m_runOffsets[state + 1];
+        auto run = lower_bound(begin, end, symbol, [](char a, char b) {
+            return static_cast<unsigned char>(a) < static_cast<unsigned char>(b);
+        });
+        if (run == end || *run != symbol)
+        {
+            return {};
+        }
+        size_t index = size_t(run - m_runSymbols.begin());
+        return { m_targets.data() + m_runStarts[index], m_runStarts[index + 1] - m_runStarts[index] };
+    }
+
+    span<const int> CsrNfa::GetEpsilonEdges(int state) const
+    {
+        return { m_epsilonTargets.data() + m_epsilonOffsets[state], m_epsilonOffsets[state + 1] - m_epsilonOffsets[state] };
+    }
+
+    // Подсчёт по отрезкам, префиксные суммы, затем копирование отрезков на свои места
+    void CsrNfa::Move(span<const int> subset, const vector<int>& symbolIndex, size_t symbolCount, SubsetMove& move) const
+    {
+        move.offsets.assign(symbolCount + 1, 0);
+        for (int state : subset)
+        {
+            for (uint32_t run = m_runOffsets[state]; run < m_runOffsets[state + 1]; run++)
+            {
+                int symbol = symbolIndex[static_cast<unsigned char>(m_runSymbols[run])];
+                if (symbol >= 0)
+                {
+                    move.offsets[symbol + 1] += m_runStarts[run + 1] - m_runStarts[run];
+                }
+            }
+        }
+        for (size_t symbol = 0; symbol < symbolCount; symbol++)
+        {
+            move.offsets[symbol + 1] += move.offsets[symbol];
+        }
+
+        move.targets.resize(move.offsets.back());
+        move.positions.assign(move.offsets.begin(), move.offsets.end() - 1);
+        for (int state : subset)
+        {
+            for (uint32_t run = m_runOffsets[state]; run < m_runOffsets[state + 1]; run++)
+            {
+                int symbol = symbolIndex[static_cast<unsigned char>(m_runSymbols[run])];
+                if (symbol >= 0)
+                {
+                    copy(m_targets.begin() + m_runStarts[run], m_targets.begin() + m_runStarts[run + 1],
+                        move.targets.begin() + move.positions[symbol]);
+                    move.positions[symbol] += m_runStarts[run + 1] - m_runStarts[run];
+                }
+            }
+        }
+    }
+}
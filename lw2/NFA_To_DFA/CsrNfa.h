@@ -0,0 +1,53 @@
+﻿#pragma once
+#include <cstdint>
+#include <span>
+#include <vector>
+#include "Nfa.h"
+
+namespace Automata
+{
+    // Переходы подмножества, разложенные по символам: цели символа с номером i
+    // лежат в targets[offsets[i]..offsets[i + 1]), повторы не убраны
+    struct SubsetMove
+    {
+        std::vector<uint32_t> offsets;
+        std::vector<int> targets;
+        std::vector<uint32_t> positions;
+    };
+
+    // Неизменяемый автомат в формате CSR. Переходы состояния отсортированы по символу и цели
+    // и разбиты на отрезки с одним символом, поэтому переходы подмножества раскладываются
+    // по символам целыми отрезками, а не по одному ребру.
+    class CsrNfa
+    {
+    public:
+        explicit CsrNfa(const Nfa& nfa);
+
+        size_t GetStateCount() const;
+        int GetStart() const;
+        bool IsAccepting(int state) const;
+        bool HasEpsilon() const;
+        size_t GetEdgeCount() const;
+        // Символы всех переходов по возрастанию
+        const std::vector<char>& GetAlphabet() const;
+
+        std::span<const int> GetTargets(int state, char symbol) const;
+        std::span<const int> GetEpsilonEdges(int state) const;
+
+        // symbolIndex - номер символа по байту или -1, если символ не нужен
+        void Move(std::span<const int> subset, const std::vector<int>& symbolIndex, size_t symbolCount, SubsetMove& move) const;
+
+    private:
+        int m_start = NO_STATE;
+        std::vector<char> m_accepting;
+        std::vector<char> m_alphabet;
+        // Отрезки состояния: m_runOffsets[state]..m_runOffsets[state + 1];
+        // цели отрезка run - m_targets[m_runStarts[run]..m_runStarts[run + 1])
+        std::vector<uint32_t> m_runOffsets;
+        std::vector<char> m_runSymbols;
+        std::vector<uint32_t> m_runStarts;
+        std::vector<int> m_targets;
+        std::vector<uint32_t> m_epsilonOffsets;
+        std::vector<int> m_epsilonTargets;
+    };
+}
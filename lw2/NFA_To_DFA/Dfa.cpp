@@ -0,0 +1,150 @@
+﻿#include "Dfa.h"
+#include <map>
+#include <stdexcept>
+
+using namespace std;
+
+namespace Automata
+{
+    Dfa::Dfa(vector<char> symbols)
+        : m_symbols(move(symbols))
+        , m_symbolIndex(256, -1)
+        , m_classCount(m_symbols.size())
+    {
+        for (size_t i = 0; i < m_symbols.size(); i++)
+        {
+            m_symbolIndex[static_cast<unsigned char>(m_symbols[i])] = int(i);
+            m_symbolClass.push_back(int(i));
+        }
+        m_byteClass = m_symbolIndex;
+    }
+
+    int Dfa::AddState(bool accepting)
+    {
+        m_next.insert(m_next.end(), m_classCount, NO_STATE);
+        m_accepting.push_back(accepting);
+        return int(m_accepting.size()) - 1;
+    }
+
+    void Dfa::SetTransition(int state, size_t symbolIndex, int target)
+    {
+        if (m_compressed)
+        {
+            throw logic_error("Cannot change transitions of a DFA with compressed symbols");
+        }
+        m_next[state * m_classCount + symbolIndex] = target;
+    }
+
+    void Dfa::SetAccepting(int state, bool accepting)
+    {
+        m_accepting[state] = accepting;
+    }
+
+    void Dfa::CompressSymbols()
+    {
+        if (m_compressed)
+        {
+            return;
+        }
+
+        const size_t stateCount = GetStateCount();
+        map<vector<int>, int> classOfColumn;
+        vector<size_t> classSymbols;
+        vector<int> column(stateCount);
+        for (size_t symbol = 0; symbol < m_symbols.size(); symbol++)
+        {
+            for (size_t state = 0; state < stateCount; state++)
+            {
+                column[state] = m_next[state * m_symbols.size() + symbol];
+            }
+            auto [it, inserted] = classOfColumn.try_emplace(column, int(classSymbols.size()));
+            if (inserted)
+            {
+                classSymbols.push_back(symbol);
+            }
+            m_symbolClass[symbol] = it->second;
+        }
+
+        vector<int> next(stateCount * classSymbols.size());
+        for (size_t state = 0; state < stateCount; state++)
+        {
+            for (size_t symbolClass = 0; symbolClass < classSymbols.size(); symbolClass++)
+            {
+                next[state * classSymbols.size() + symbolClass] = m_next[state * m_symbols.size() + classSymbols[symbolClass]];
+            }
+        }
+
+        m_next = move(next);
+        m_classCount = classSymbols.size();
+        for (size_t symbol = 0; symbol < m_symbols.size(); symbol++)
+        {
+            m_byteClass[static_cast<unsigned char>(m_symbols[symbol])] = m_symbolClass[symbol];
+        }
+        m_compressed = true;
+    }
+
+    size_t Dfa::GetStateCount() const
+    {
+        return m_accepting.size();
+    }
+
+    const vector<char>& Dfa::GetSymbols() const
+    {
+        return m_symbols;
+    }
+
+    int Dfa::GetSymbolIndex(char symbol) const
+    {
+        return m_symbolIndex[static_cast<unsigned char>(symbol)];
+    }
+
+    int Dfa::GetNextState(int state, size_t symbolIndex) const
+    {
+        return m_next[state * m_classCount + m_symbolClass[symbolIndex]];
+    }
+
+    int Dfa::GetNextStateBySymbol(int state, char symbol) const
+    {
+        int symbolClass = m_byteClass[static_cast<unsigned char>(symbol)];
+        return symbolClass < 0 ? NO_STATE : m_next[state * m_classCount + symbolClass];
+    }
+
+    size_t Dfa::GetClassCount() const
+    {
+        return m_classCount;
+    }
+
+    int Dfa::GetSymbolClass(size_t symbolIndex) const
+    {
+        return m_symbolClass[symbolIndex];
+    }
+
+    int Dfa::GetNextStateByClass(int state, size_t symbolClass) const
+    {
+        return m_next[state * m_classCount + symbolClass];
+    }
+
+    bool Dfa::IsAccepting(int state) const
+    {
+        return m_accepting[state];
+    }
+
+    bool Dfa::Accepts(string_view input) const
+    {
+        if (m_accepting.empty())
+        {
+            return false;
+        }
+
+        int state = 0;
+        for (char symbol : input)
+        {
+            state = GetNextStateBySymbol(state, symbol);
+            if (state == NO_STATE)
+            {
+                return false;
+            }
+        }
+        return m_accepting[state];
+    }
+}
@@ -0,0 +1,46 @@
+﻿#pragma once
+#include <string_view>
+#include <vector>
+#include "Nfa.h"
+
+namespace Automata
+{
+    // Детерминированный автомат с плотной таблицей переходов, начальное состояние 0.
+    // Столбец таблицы - класс символов: до CompressSymbols у каждого символа свой класс,
+    // переход state по классу k лежит в next[state * GetClassCount() + k], NO_STATE - перехода нет.
+    class Dfa
+    {
+    public:
+        explicit Dfa(std::vector<char> symbols = {});
+
+        int AddState(bool accepting = false);
+        void SetTransition(int state, size_t symbolIndex, int target);
+        void SetAccepting(int state, bool accepting = true);
+        // Объединяет символы, переходы по которым совпадают во всех состояниях, в один класс.
+        // После этого SetTransition недоступен.
+        void CompressSymbols();
+
+        size_t GetStateCount() const;
+        const std::vector<char>& GetSymbols() const;
+        // Номер символа в алфавите или -1
+        int GetSymbolIndex(char symbol) const;
+        int GetNextState(int state, size_t symbolIndex) const;
+        int GetNextStateBySymbol(int state, char symbol) const;
+        size_t GetClassCount() const;
+        int GetSymbolClass(size_t symbolIndex) const;
+        int GetNextStateByClass(int state, size_t symbolClass) const;
+        bool IsAccepting(int state) const;
+        bool Accepts(std::string_view input) const;
+
+    private:
+        std::vector<char> m_symbols;
+        std::vector<int> m_symbolIndex;
+        std::vector<int> m_symbolClass;
+        // Класс каждого байта или -1
+        std::vector<int> m_byteClass;
+        size_t m_classCount = 0;
+        bool m_compressed = false;
+        std::vector<int> m_next;
+        std::vector<char> m_accepting;
+    };
+}
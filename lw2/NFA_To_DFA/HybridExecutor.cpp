@@ -0,0 +1,102 @@
+﻿#include "HybridExecutor.h"
+#include <cstdint>
+
+using namespace std;
+
+namespace Automata
+{
+    HybridExecutor::HybridExecutor(const Nfa& nfa, const DeterminizeOptions& options)
+        : m_nfa(nfa)
+    {
+        SubsetEngine engine;
+        m_dfa = engine.Determinize(m_nfa, options, m_report);
+        for (size_t state = m_report.expandedStates; state < engine.GetSubsetCount(); state++)
+        {
+            auto subset = engine.GetSubset(int(state));
+            m_frontier.emplace_back(subset.begin(), subset.end());
+        }
+        m_dfa.CompressSymbols();
+    }
+
+    bool HybridExecutor::Accepts(string_view input) const
+    {
+        if (m_dfa.GetStateCount() == 0)
+        {
+            return false;
+        }
+
+        int state = 0;
+        for (size_t i = 0; i < input.size(); i++)
+        {
+            if (size_t(state) >= m_report.expandedStates)
+            {
+                return Simulate(m_frontier[state - m_report.expandedStates], input.substr(i));
+            }
+            state = m_dfa.GetNextStateBySymbol(state, input[i]);
+            if (state == NO_STATE)
+            {
+                return false;
+            }
+        }
+        return m_dfa.IsAccepting(state);
+    }
+
+    const Dfa& HybridExecutor::GetDfa() const
+    {
+        return m_dfa;
+    }
+
+    const DeterminizeReport& HybridExecutor::GetReport() const
+    {
+        return m_report;
+    }
+
+    // states уже замкнуто по эпсилон-переходам
+    bool HybridExecutor::Simulate(vector<int> states, string_view input) const
+    {
+        vector<uint32_t> marks(m_nfa.GetStateCount(), 0);
+        uint32_t generation = 0;
+        vector<int> next;
+        for (char symbol : input)
+        {
+            generation++;
+            next.clear();
+            for (int state : states)
+            {
+                for (int target : m_nfa.GetTargets(state, symbol))
+                {
+                    if (marks[target] != generation)
+                    {
+                        marks[target] = generation;
+                        next.push_back(target);
+                    }
+                }
+            }
+            for (size_t i = 0; i < next.size(); i++)
+            {
+                for (int target : m_nfa.GetEpsilonEdges(next[i]))
+                {
+                    if (marks[target] != generation)
+                    {
+                        marks[target] = generation;
+                        next.push_back(target);
+                    }
+                }
+            }
+            if (next.empty())
+            {
+                return false;
+            }
+            states.swap(next);
+        }
+
+        for (int state : states)
+        {
+            if (m_nfa.IsAccepting(state))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+}
@@ -0,0 +1,32 @@
+﻿#pragma once
+#include <string_view>
+#include <vector>
+#include "CsrNfa.h"
+#include "Dfa.h"
+#include "Nfa.h"
+#include "SubsetEngine.h"
+
+namespace Automata
+{
+    // Детерминизация в пределах бюджета: по построенной части DFA (состояния рядом с начальным)
+    // вход проходит по таблице, с первого не развёрнутого состояния продолжается моделирование NFA.
+    class HybridExecutor
+    {
+    public:
+        HybridExecutor(const Nfa& nfa, const DeterminizeOptions& options);
+
+        bool Accepts(std::string_view input) const;
+
+        const Dfa& GetDfa() const;
+        const DeterminizeReport& GetReport() const;
+
+    private:
+        bool Simulate(std::vector<int> states, std::string_view input) const;
+
+        CsrNfa m_nfa;
+        Dfa m_dfa;
+        DeterminizeReport m_report;
+        // Подмножества не развёрнутых состояний DFA, начиная с m_report.expandedStates
+        std::vector<std::vector<int>> m_frontier;
+    };
+}
@@ -0,0 +1,399 @@
+﻿#include "Minimize.h"
+#include <algorithm>
+#include <chrono>
+#include <numeric>
+#include <stdexcept>
+
+using namespace std;
+
+namespace
+{
+    // Блоки разбиения лежат в m_elements подряд, отмеченные при разбиении элементы - в начале блока
+    class Partition
+    {
+    public:
+        explicit Partition(size_t size)
+            : m_elements(size)
+            , m_location(size)
+            , m_blockOf(size, 0)
+            , m_begin{ 0 }
+            , m_end{ size }
+            , m_marked{ 0 }
+        {
+            iota(m_elements.begin(), m_elements.end(), 0);
+            iota(m_location.begin(), m_location.end(), 0);
+        }
+
+        size_t GetBlockCount() const
+        {
+            return m_begin.size();
+        }
+
+        int GetBlock(int element) const
+        {
+            return m_blockOf[element];
+        }
+
+        size_t GetSize(int block) const
+        {
+            return m_end[block] - m_begin[block];
+        }
+
+        const int* GetElements(int block) const
+        {
+            return m_elements.data() + m_begin[block];
+        }
+
+        void Mark(int element)
+        {
+            const int block = m_blockOf[element];
+            const size_t position = m_location[element];
+            const size_t markedEnd = m_begin[block] + m_marked[block];
+            if (position < markedEnd)
+            {
+                return;
+            }
+            swap(m_elements[position], m_elements[markedEnd]);
+            m_location[m_elements[position]] = position;
+            m_location[element] = markedEnd;
+            if (m_marked[block]++ == 0)
+            {
+                m_touched.push_back(block);
+            }
+        }
+
+        // Отмеченная часть каждого затронутого блока, если он отмечен не целиком, становится
+        // новым блоком; onSplit(block, newBlock)
+        template <class OnSplit>
+        void SplitMarked(OnSplit onSplit)
+        {
+            for (int block : m_touched)
+            {
+                const size_t marked = m_marked[block];
+                m_marked[block] = 0;
+                if (marked == GetSize(block))
+                {
+                    continue;
+                }
+                const int newBlock = int(m_begin.size());
+                m_begin.push_back(m_begin[block]);
+                m_end.push_back(m_begin[block] + marked);
+                m_marked.push_back(0);
+                m_begin[block] += marked;
+                for (size_t i = m_begin[newBlock]; i < m_end[newBlock]; i++)
+                {
+                    m_blockOf[m_elements[i]] = newBlock;
+                }
+                onSplit(block, newBlock);
+            }
+            m_touched.clear();
+        }
+
+    private:
+        vector<int> m_elements;
+        vector<size_t> m_location;
+        vector<int> m_blockOf;
+        vector<size_t> m_begin;
+        vector<size_t> m_end;
+        vector<size_t> m_marked;
+        vector<int> m_touched;
+    };
+
+    // Состояния, достижимые из start, в порядке обхода в ширину по символам; start получает номер 0
+    Automata::Dfa Reroot(const Automata::Dfa& dfa, int start)
+    {
+        Automata::Dfa result(dfa.GetSymbols());
+        vector<int> newIds(dfa.GetStateCount(), Automata::NO_STATE);
+        vector<int> order{ start };
+        newIds[start] = 0;
+        for (size_t i = 0; i < order.size(); i++)
+        {
+            result.AddState(dfa.IsAccepting(order[i]));
+            for (size_t symbol = 0; symbol < dfa.GetSymbols().size(); symbol++)
+            {
+                int target = dfa.GetNextState(order[i], symbol);
+                if (target == Automata::NO_STATE)
+                {
+                    continue;
+                }
+                if (newIds[target] == Automata::NO_STATE)
+                {
+                    newIds[target] = int(order.size());
+                    order.push_back(target);
+                }
+                result.SetTransition(int(i), symbol, newIds[target]);
+            }
+        }
+        return result;
+    }
+
+    double GetMilliseconds(chrono::steady_clock::time_point start)
+    {
+        return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    }
+}
+
+namespace Automata
+{
+    MinimizeStrategy ParseMinimizeStrategy(const string& strategy)
+    {
+        if (strategy == "subset")
+        {
+            return MinimizeStrategy::Subset;
+        }
+        if (strategy == "brzozowski")
+        {
+            return MinimizeStrategy::Brzozowski;
+        }
+        throw invalid_argument("Strategy should be subset or brzozowski");
+    }
+
+    Dfa Minimize(const Dfa& dfa, vector<int>& stateMap)
+    {
+        const size_t stateCount = dfa.GetStateCount();
+        const size_t classCount = dfa.GetClassCount();
+        stateMap.assign(stateCount, NO_STATE);
+        Dfa minimized(dfa.GetSymbols());
+        if (stateCount == 0)
+        {
+            return minimized;
+        }
+
+        // Состояние stateCount - тупик, в него ведут отсутствующие переходы.
+        // Обратные переходы по (цели, классу): sources[offsets[cell]..offsets[cell + 1])
+        const int dead = int(stateCount);
+        auto targetOf = [&](int state, size_t symbolClass) {
+            int target = state == dead ? NO_STATE : dfa.GetNextStateByClass(state, symbolClass);
+            return target == NO_STATE ? dead : target;
+        };
+        vector<uint32_t> offsets((stateCount + 1) * classCount + 1, 0);
+        for (int state = 0; state <= dead; state++)
+        {
+            for (size_t symbolClass = 0; symbolClass < classCount; symbolClass++)
+            {
+                offsets[targetOf(state, symbolClass) * classCount + symbolClass + 1]++;
+            }
+        }
+        partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+        vector<int> sources(offsets.back());
+        vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+        for (int state = 0; state <= dead; state++)
+        {
+            for (size_t symbolClass = 0; symbolClass < classCount; symbolClass++)
+            {
+                sources[fill[targetOf(state, symbolClass) * classCount + symbolClass]++] = state;
+            }
+        }
+
+        Partition partition(stateCount + 1);
+        vector<char> inWorklist;
+        vector<int> worklist;
+        auto onSplit = [&](int block, int newBlock) {
+            inWorklist.resize(partition.GetBlockCount(), false);
+            // Достаточно меньшей половины, если блок ещё не в очереди
+            int added = inWorklist[block] || partition.GetSize(newBlock) <= partition.GetSize(block) ? newBlock : block;
+            if (!inWorklist[added])
+            {
+                inWorklist[added] = true;
+                worklist.push_back(added);
+            }
+        };
+        for (int state = 0; state < dead; state++)
+        {
+            if (dfa.IsAccepting(state))
+            {
+                partition.Mark(state);
+            }
+        }
+        inWorklist.assign(1, false);
+        partition.SplitMarked(onSplit);
+
+        vector<int> splitter;
+        while (!worklist.empty())
+        {
+            int block = worklist.back();
+            worklist.pop_back();
+            inWorklist[block] = false;
+            splitter.assign(partition.GetElements(block), partition.GetElements(block) + partition.GetSize(block));
+            for (size_t symbolClass = 0; symbolClass < classCount; symbolClass++)
+            {
+                for (int target : splitter)
+                {
+                    const size_t cell = target * classCount + symbolClass;
+                    for (uint32_t i = offsets[cell]; i < offsets[cell + 1]; i++)
+                    {
+                        partition.Mark(sources[i]);
+                    }
+                }
+                partition.SplitMarked(onSplit);
+            }
+        }
+
+        // Блок тупика - состояния, из которых не достичь заключительного
+        const int deadBlock = partition.GetBlock(dead);
+        vector<int> newIdOfBlock(partition.GetBlockCount(), NO_STATE);
+        vector<int> order{ partition.GetBlock(0) };
+        newIdOfBlock[order[0]] = 0;
+        for (size_t i = 0; i < order.size(); i++)
+        {
+            const int representative = partition.GetElements(order[i])[0];
+            minimized.AddState(representative != dead && dfa.IsAccepting(representative));
+            if (order[i] == deadBlock)
+            {
+                continue;
+            }
+            for (size_t symbol = 0; symbol < dfa.GetSymbols().size(); symbol++)
+            {
+                const int targetBlock = partition.GetBlock(targetOf(representative, size_t(dfa.GetSymbolClass(symbol))));
+                if (targetBlock == deadBlock)
+                {
+                    continue;
+                }
+                if (newIdOfBlock[targetBlock] == NO_STATE)
+                {
+                    newIdOfBlock[targetBlock] = int(order.size());
+                    order.push_back(targetBlock);
+                }
+                minimized.SetTransition(int(i), symbol, newIdOfBlock[targetBlock]);
+            }
+        }
+
+        for (int state = 0; state < dead; state++)
+        {
+            const int block = partition.GetBlock(state);
+            stateMap[state] = block == deadBlock && state != 0 ? NO_STATE : newIdOfBlock[block];
+        }
+        return minimized;
+    }
+
+    Dfa Minimize(const Dfa& dfa)
+    {
+        vector<int> stateMap;
+        return Minimize(dfa, stateMap);
+    }
+
+    Nfa Reverse(const Nfa& nfa)
+    {
+        Nfa reversed;
+        for (size_t state = 0; state < nfa.GetStateCount(); state++)
+        {
+            reversed.AddState(int(state) == nfa.GetStart());
+        }
+        const int start = reversed.AddState();
+        reversed.SetStart(start);
+        for (int state = 0; state < int(nfa.GetStateCount()); state++)
+        {
+            if (nfa.IsAccepting(state))
+            {
+                reversed.AddEpsilon(start, state);
+            }
+            for (const auto& edge : nfa.GetEdges(state))
+            {
+                reversed.AddTransition(edge.target, edge.symbol, state);
+            }
+            for (int target : nfa.GetEpsilonEdges(state))
+            {
+                reversed.AddEpsilon(target, state);
+            }
+        }
+        return reversed;
+    }
+
+    Nfa Reverse(const Dfa& dfa)
+    {
+        Nfa reversed;
+        for (size_t state = 0; state < dfa.GetStateCount(); state++)
+        {
+            reversed.AddState(state == 0);
+        }
+        const int start = reversed.AddState();
+        reversed.SetStart(start);
+        const auto& symbols = dfa.GetSymbols();
+        for (int state = 0; state < int(dfa.GetStateCount()); state++)
+        {
+            if (dfa.IsAccepting(state))
+            {
+                reversed.AddEpsilon(start, state);
+            }
+            for (size_t symbol = 0; symbol < symbols.size(); symbol++)
+            {
+                int target = dfa.GetNextState(state, symbol);
+                if (target != NO_STATE)
+                {
+                    reversed.AddTransition(target, symbols[symbol], state);
+                }
+            }
+        }
+        return reversed;
+    }
+
+    Dfa DeterminizeMinimal(const Nfa& nfa, MinimizeStrategy strategy, const DeterminizeOptions& options,
+        MinimizeReport& report)
+    {
+        const auto start = chrono::steady_clock::now();
+        report = {};
+        DeterminizeOptions passOptions = options;
+        if (passOptions.alphabet.empty())
+        {
+            // Обращённый DFA может потерять символы, по которым переходов не осталось
+            passOptions.alphabet = nfa.GetAlphabet();
+        }
+
+        SubsetEngine engine;
+        auto determinize = [&](const Nfa& source, Dfa& result) {
+            DeterminizeReport pass;
+            result = engine.Determinize(source, passOptions, pass);
+            report.peakStates = max(report.peakStates, result.GetStateCount());
+            report.peakBytes = max(report.peakBytes, pass.peakBytes);
+            report.complete = report.complete && pass.complete;
+            return report.complete;
+        };
+
+        // Как и построение подмножеств, по NFA без состояний - DFA без состояний
+        Dfa dfa(passOptions.alphabet);
+        if (nfa.GetStateCount() == 0)
+        {
+            report.milliseconds = GetMilliseconds(start);
+            return dfa;
+        }
+
+        if (strategy == MinimizeStrategy::Subset)
+        {
+            if (determinize(nfa, dfa))
+            {
+                dfa = Minimize(dfa);
+            }
+        }
+        else
+        {
+            // Построение подмножеств по обращению детерминированного достижимого автомата
+            // даёт минимальный DFA, поэтому обращение выполняется дважды
+            Dfa reversed;
+            if (determinize(Reverse(nfa), reversed) && determinize(Reverse(reversed), dfa))
+            {
+                // Добавленное обращением начальное состояние (последний номер) входит только
+                // в начальное подмножество; без него оно может совпасть с другим подмножеством
+                // того же языка, тогда начальным становится это подмножество
+                auto startSubset = engine.GetSubset(0);
+                auto rest = startSubset.first(startSubset.size() - 1);
+                for (int state = 1; state < int(engine.GetSubsetCount()); state++)
+                {
+                    auto subset = engine.GetSubset(state);
+                    if (equal(subset.begin(), subset.end(), rest.begin(), rest.end()))
+                    {
+                        dfa = Reroot(dfa, state);
+                        break;
+                    }
+                }
+            }
+        }
+
+        if (!report.complete)
+        {
+            dfa = Dfa(passOptions.alphabet);
+        }
+        report.resultStates = dfa.GetStateCount();
+        report.milliseconds = GetMilliseconds(start);
+        return dfa;
+    }
+}
@@ -0,0 +1,47 @@
+﻿#pragma once
+#include <string>
+#include <vector>
+#include "Dfa.h"
+#include "Nfa.h"
+#include "SubsetEngine.h"
+
+namespace Automata
+{
+    enum class MinimizeStrategy
+    {
+        // Построение подмножеств, затем склейка эквивалентных состояний
+        Subset,
+        // Бжозовский: дважды построение подмножеств по обращённому автомату
+        Brzozowski,
+    };
+
+    MinimizeStrategy ParseMinimizeStrategy(const std::string& strategy);
+
+    struct MinimizeReport
+    {
+        // false - бюджет превышен на одном из построений подмножеств
+        bool complete = true;
+        // Наибольший из DFA, построенных по пути к минимальному
+        size_t peakStates = 0;
+        size_t peakBytes = 0;
+        size_t resultStates = 0;
+        double milliseconds = 0;
+    };
+
+    // Минимальный DFA того же языка: состояния, из которых не достичь заключительного, убраны,
+    // эквивалентные склеены (Хопкрофт, отсутствующий переход ведёт в неявный тупик).
+    // Состояния нумеруются обходом в ширину по символам, как при построении подмножеств.
+    // stateMap[old] - новый номер состояния или NO_STATE, если оно убрано.
+    Dfa Minimize(const Dfa& dfa, std::vector<int>& stateMap);
+    Dfa Minimize(const Dfa& dfa);
+
+    // Переходы развёрнуты, заключительное - бывшее начальное; новое начальное состояние
+    // с эпсилон-переходами во все бывшие заключительные
+    Nfa Reverse(const Nfa& nfa);
+    Nfa Reverse(const Dfa& dfa);
+
+    // Минимальный DFA по NFA выбранным способом; при превышении бюджета report.complete == false
+    // и возвращается пустой DFA. Пустой options.alphabet - все символы NFA.
+    Dfa DeterminizeMinimal(const Nfa& nfa, MinimizeStrategy strategy, const DeterminizeOptions& options,
+        MinimizeReport& report);
+}
@@ -0,0 +1,124 @@
+﻿#include "MultiPattern.h"
+#include <algorithm>
+#include <map>
+#include <stdexcept>
+
+using namespace std;
+
+namespace Automata
+{
+    Nfa BuildUnion(const vector<Nfa>& patterns, vector<int>& patternOf)
+    {
+        Nfa result;
+        const int start = result.AddState();
+        patternOf.assign(1, NO_STATE);
+
+        for (size_t pattern = 0; pattern < patterns.size(); pattern++)
+        {
+            const Nfa& nfa = patterns[pattern];
+            if (nfa.GetStart() == NO_STATE)
+            {
+                continue;
+            }
+
+            const int offset = int(result.GetStateCount());
+            for (size_t state = 0; state < nfa.GetStateCount(); state++)
+            {
+                result.AddState(nfa.IsAccepting(int(state)));
+                patternOf.push_back(int(pattern));
+            }
+            for (size_t state = 0; state < nfa.GetStateCount(); state++)
+            {
+                for (const auto& edge : nfa.GetEdges(int(state)))
+                {
+                    result.AddTransition(offset + int(state), edge.symbol, offset + edge.target);
+                }
+                for (int target : nfa.GetEpsilonEdges(int(state)))
+                {
+                    result.AddEpsilon(offset + int(state), offset + target);
+                }
+            }
+            result.AddEpsilon(start, offset + nfa.GetStart());
+        }
+
+        result.SetStart(start);
+        return result;
+    }
+
+    MultiPatternDfa::MultiPatternDfa(const vector<Nfa>& patterns, const DeterminizeOptions& options)
+        : m_patternCount(patterns.size())
+    {
+        vector<int> patternOf;
+        Nfa nfa = BuildUnion(patterns, patternOf);
+
+        SubsetEngine engine;
+        DeterminizeReport report;
+        m_dfa = engine.Determinize(nfa, options, report);
+        if (!report.complete)
+        {
+            throw runtime_error("Determinization budget exceeded: " + to_string(report.expandedStates) + " states expanded");
+        }
+
+        // Одинаковые наборы образцов у разных состояний хранятся один раз
+        map<vector<int>, int> setIndex{ { {}, 0 } };
+        vector<int> current;
+        m_stateSet.resize(m_dfa.GetStateCount());
+        for (size_t state = 0; state < m_dfa.GetStateCount(); state++)
+        {
+            current.clear();
+            for (int nfaState : engine.GetSubset(int(state)))
+            {
+                if (nfa.IsAccepting(nfaState))
+                {
+                    current.push_back(patternOf[nfaState]);
+                }
+            }
+            sort(current.begin(), current.end());
+            current.erase(unique(current.begin(), current.end()), current.end());
+
+            auto [it, inserted] = setIndex.try_emplace(current, int(m_setOffsets.size()) - 1);
+            if (inserted)
+            {
+                m_setData.insert(m_setData.end(), current.begin(), current.end());
+                m_setOffsets.push_back(m_setData.size());
+            }
+            m_stateSet[state] = it->second;
+        }
+        m_dfa.CompressSymbols();
+    }
+
+    size_t MultiPatternDfa::GetPatternCount() const
+    {
+        return m_patternCount;
+    }
+
+    const Dfa& MultiPatternDfa::GetDfa() const
+    {
+        return m_dfa;
+    }
+
+    span<const int> MultiPatternDfa::GetPatterns(int state) const
+    {
+        const int set = m_stateSet.at(state);
+        return span<const int>(m_setData.data() + m_setOffsets[set], m_setOffsets[set + 1] - m_setOffsets[set]);
+    }
+
+    size_t MultiPatternDfa::GetPatternSetCount() const
+    {
+        return m_setOffsets.size() - 1;
+    }
+
+    span<const int> MultiPatternDfa::Match(string_view input) const
+    {
+        int state = 0;
+        for (char symbol : input)
+        {
+            state = m_dfa.GetNextStateBySymbol(state, symbol);
+            if (state == NO_STATE)
+            {
+                return {};
+            }
+        }
+        return GetPatterns(state);
+    }
+}
@@ -0,0 +1,40 @@
+﻿#pragma once
+#include <span>
+#include <string_view>
+#include <vector>
+#include "Dfa.h"
+#include "Nfa.h"
+#include "SubsetEngine.h"
+
+namespace Automata
+{
+    // Объединение нескольких образцов в один DFA: вход просматривается один раз
+    // независимо от числа образцов. Состояние знает номера образцов, которые в нём допускаются.
+    class MultiPatternDfa
+    {
+    public:
+        // При превышении бюджета options бросает runtime_error
+        explicit MultiPatternDfa(const std::vector<Nfa>& patterns, const DeterminizeOptions& options = {});
+
+        size_t GetPatternCount() const;
+        const Dfa& GetDfa() const;
+        // Номера образцов по возрастанию, пусто - состояние не заключительное
+        std::span<const int> GetPatterns(int state) const;
+        // Число различных наборов образцов, каждый хранится один раз
+        size_t GetPatternSetCount() const;
+        // Образцы, допускающие всю строку
+        std::span<const int> Match(std::string_view input) const;
+
+    private:
+        size_t m_patternCount = 0;
+        Dfa m_dfa;
+        // Набор k: m_setData[m_setOffsets[k]..m_setOffsets[k + 1]), набор 0 пустой
+        std::vector<int> m_setData;
+        std::vector<size_t> m_setOffsets{ 0, 0 };
+        std::vector<int> m_stateSet;
+    };
+
+    // Новое начальное состояние с эпсилон-переходами в начальные состояния образцов.
+    // patternOf - номер образца для каждого состояния результата, у начального NO_STATE.
+    Nfa BuildUnion(const std::vector<Nfa>& patterns, std::vector<int>& patternOf);
+}
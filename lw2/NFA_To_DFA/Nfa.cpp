@@ -0,0 +1,108 @@
+﻿#include "Nfa.h"
+#include <algorithm>
+#include <stdexcept>
+
+using namespace std;
+
+namespace Automata
+{
+    int Nfa::AddState(bool accepting)
+    {
+        m_edges.emplace_back();
+        m_epsilonEdges.emplace_back();
+        m_accepting.push_back(accepting);
+        if (m_start == NO_STATE)
+        {
+            m_start = 0;
+        }
+        return int(m_edges.size()) - 1;
+    }
+
+    void Nfa::AddTransition(int from, char symbol, int to)
+    {
+        CheckState(from);
+        CheckState(to);
+        m_edges[from].push_back({ symbol, to });
+    }
+
+    void Nfa::AddEpsilon(int from, int to)
+    {
+        CheckState(from);
+        CheckState(to);
+        m_epsilonEdges[from].push_back(to);
+        m_hasEpsilon = true;
+    }
+
+    void Nfa::SetStart(int state)
+    {
+        CheckState(state);
+        m_start = state;
+    }
+
+    void Nfa::SetAccepting(int state, bool accepting)
+    {
+        CheckState(state);
+        m_accepting[state] = accepting;
+    }
+
+    size_t Nfa::GetStateCount() const
+    {
+        return m_edges.size();
+    }
+
+    int Nfa::GetStart() const
+    {
+        return m_start;
+    }
+
+    bool Nfa::IsAccepting(int state) const
+    {
+        return m_accepting[state];
+    }
+
+    bool Nfa::HasEpsilon() const
+    {
+        return m_hasEpsilon;
+    }
+
+    const vector<Nfa::Edge>& Nfa::GetEdges(int state) const
+    {
+        return m_edges[state];
+    }
+
+    const vector<int>& Nfa::GetEpsilonEdges(int state) const
+    {
+        return m_epsilonEdges[state];
+    }
+
+    vector<char> Nfa::GetAlphabet() const
+    {
+        vector<bool> used(256, false);
+        for (const auto& edges : m_edges)
+        {
+            for (const auto& edge : edges)
+            {
+                used[static_cast<unsigned char>(edge.symbol)] = true;
+            }
+        }
+
+        vector<char> alphabet;
+        for (int symbol = 0; symbol < 256; symbol++)
+        {
+            if (used[symbol])
+            {
+                alphabet.push_back(char(symbol));
+            }
+        }
+        sort(alphabet.begin(), alphabet.end());
+        return alphabet;
+    }
+
+    void Nfa::CheckState(int state) const
+    {
+        if (state < 0 || state >= int(m_edges.size()))
+        {
+            throw out_of_range("Unknown NFA state " + to_string(state));
+        }
+    }
+}
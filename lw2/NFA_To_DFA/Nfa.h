@@ -0,0 +1,44 @@
+﻿#pragma once
+#include <string>
+#include <vector>
+
+namespace Automata
+{
+    const int NO_STATE = -1;
+
+    // Недетерминированный автомат над произвольным алфавитом байтов с эпсилон-переходами.
+    // После построения только читается, поэтому один экземпляр можно использовать из многих потоков.
+    class Nfa
+    {
+    public:
+        struct Edge
+        {
+            char symbol;
+            int target;
+        };
+
+        int AddState(bool accepting = false);
+        void AddTransition(int from, char symbol, int to);
+        void AddEpsilon(int from, int to);
+        void SetStart(int state);
+        void SetAccepting(int state, bool accepting = true);
+
+        size_t GetStateCount() const;
+        int GetStart() const;
+        bool IsAccepting(int state) const;
+        bool HasEpsilon() const;
+        const std::vector<Edge>& GetEdges(int state) const;
+        const std::vector<int>& GetEpsilonEdges(int state) const;
+        // Символы всех переходов по возрастанию
+        std::vector<char> GetAlphabet() const;
+
+    private:
+        void CheckState(int state) const;
+
+        int m_start = NO_STATE;
+        std::vector<std::vector<Edge>> m_edges;
+        std::vector<std::vector<int>> m_epsilonEdges;
+        std::vector<char> m_accepting;
+        bool m_hasEpsilon = false;
+    };
+}
@@ -0,0 +1,254 @@
+﻿#include "Product.h"
+#include <algorithm>
+#include <map>
+#include <stdexcept>
+#include "../../common/Trim.h"
+
+using namespace std;
+
+namespace Automata
+{
+    LazyProduct::LazyProduct(const Dfa& left, const Dfa& right, ProductOperation operation)
+        : m_left(left)
+        , m_right(right)
+        , m_operation(operation)
+        , m_leftUseful(FindUsefulStates(left))
+        , m_rightUseful(FindUsefulStates(right))
+    {
+        m_symbols = left.GetSymbols();
+        m_symbols.insert(m_symbols.end(), right.GetSymbols().begin(), right.GetSymbols().end());
+        sort(m_symbols.begin(), m_symbols.end());
+        m_symbols.erase(unique(m_symbols.begin(), m_symbols.end()), m_symbols.end());
+
+        map<Pair, int> classOfPair;
+        for (char symbol : m_symbols)
+        {
+            int leftSymbol = left.GetSymbolIndex(symbol);
+            int rightSymbol = right.GetSymbolIndex(symbol);
+            Pair classes{ leftSymbol < 0 ? -1 : left.GetSymbolClass(leftSymbol), rightSymbol < 0 ? -1 : right.GetSymbolClass(rightSymbol) };
+            auto [it, inserted] = classOfPair.try_emplace(classes, int(m_classes.size()));
+            if (inserted)
+            {
+                m_classes.push_back(classes);
+                m_classSymbols.push_back(symbol);
+            }
+            m_symbolClass.push_back(it->second);
+        }
+    }
+
+    bool LazyProduct::Accepts(string_view input) const
+    {
+        Pair pair = Normalize(0, 0);
+        for (char symbol : input)
+        {
+            if (IsDead(pair))
+            {
+                return false;
+            }
+            pair = Normalize(
+                pair.first == NO_STATE ? NO_STATE : m_left.GetNextStateBySymbol(pair.first, symbol),
+                pair.second == NO_STATE ? NO_STATE : m_right.GetNextStateBySymbol(pair.second, symbol));
+        }
+        return IsAccepting(pair);
+    }
+
+    optional<string> LazyProduct::FindWitness()
+    {
+        ResetPairs();
+        Pair start = Normalize(0, 0);
+        if (IsDead(start))
+        {
+            return nullopt;
+        }
+
+        // Для восстановления строки: из какой пары и по какому символу пришли
+        vector<int> parents{ NO_STATE };
+        vector<char> symbols{ 0 };
+        FindOrAdd(start);
+
+        for (size_t current = 0; current < m_pairs.size(); current++)
+        {
+            if (IsAccepting(m_pairs[current]))
+            {
+                string witness;
+                for (int pair = int(current); parents[pair] != NO_STATE; pair = parents[pair])
+                {
+                    witness += symbols[pair];
+                }
+                reverse(witness.begin(), witness.end());
+                return witness;
+            }
+
+            for (size_t productClass = 0; productClass < m_classes.size(); productClass++)
+            {
+                Pair next = Step(m_pairs[current], productClass);
+                if (IsDead(next))
+                {
+                    continue;
+                }
+                size_t countBefore = m_pairs.size();
+                FindOrAdd(next);
+                if (m_pairs.size() != countBefore)
+                {
+                    parents.push_back(int(current));
+                    symbols.push_back(m_classSymbols[productClass]);
+                }
+            }
+        }
+
+        return nullopt;
+    }
+
+    bool LazyProduct::IsEmpty()
+    {
+        return !FindWitness();
+    }
+
+    Dfa LazyProduct::Materialize(size_t maxStates)
+    {
+        ResetPairs();
+        Dfa result(m_symbols);
+        Pair start = Normalize(0, 0);
+        if (IsDead(start))
+        {
+            result.AddState();
+            return result;
+        }
+
+        FindOrAdd(start);
+        vector<int> targets(m_classes.size());
+        for (size_t current = 0; current < m_pairs.size(); current++)
+        {
+            result.AddState(IsAccepting(m_pairs[current]));
+            for (size_t productClass = 0; productClass < m_classes.size(); productClass++)
+            {
+                Pair next = Step(m_pairs[current], productClass);
+                targets[productClass] = IsDead(next) ? NO_STATE : FindOrAdd(next);
+                if (m_pairs.size() > maxStates)
+                {
+                    throw runtime_error("Product has more than " + to_string(maxStates) + " states");
+                }
+            }
+            for (size_t symbol = 0; symbol < m_symbols.size(); symbol++)
+            {
+                result.SetTransition(int(current), symbol, targets[m_symbolClass[symbol]]);
+            }
+        }
+
+        result.CompressSymbols();
+        return result;
+    }
+
+    size_t LazyProduct::GetExploredCount() const
+    {
+        return m_pairs.size();
+    }
+
+    vector<char> LazyProduct::FindUsefulStates(const Dfa& dfa)
+    {
+        const size_t stateCount = dfa.GetStateCount();
+        const size_t classCount = dfa.GetClassCount();
+        vector<pair<uint32_t, uint32_t>> edges;
+        vector<uint32_t> accepting;
+        for (size_t state = 0; state < stateCount; state++)
+        {
+            if (dfa.IsAccepting(int(state)))
+            {
+                accepting.push_back(uint32_t(state));
+            }
+            for (size_t symbolClass = 0; symbolClass < classCount; symbolClass++)
+            {
+                int target = dfa.GetNextStateByClass(int(state), symbolClass);
+                if (target != NO_STATE)
+                {
+                    edges.emplace_back(uint32_t(state), uint32_t(target));
+                }
+            }
+        }
+
+        vector<char> useful(stateCount, false);
+        if (stateCount == 0)
+        {
+            return useful;
+        }
+        Bitset found = ::FindUsefulStates(BuildCsr(stateCount, edges), { 0 }, accepting);
+        for (size_t state = 0; state < stateCount; state++)
+        {
+            useful[state] = found.Test(state);
+        }
+        return useful;
+    }
+
+    LazyProduct::Pair LazyProduct::Normalize(int left, int right) const
+    {
+        if (left != NO_STATE && (size_t(left) >= m_leftUseful.size() || !m_leftUseful[left]))
+        {
+            left = NO_STATE;
+        }
+        if (right != NO_STATE && (size_t(right) >= m_rightUseful.size() || !m_rightUseful[right]))
+        {
+            right = NO_STATE;
+        }
+        return { left, right };
+    }
+
+    LazyProduct::Pair LazyProduct::Step(Pair pair, size_t productClass) const
+    {
+        auto [leftClass, rightClass] = m_classes[productClass];
+        int left = NO_STATE, right = NO_STATE;
+        if (pair.first != NO_STATE && leftClass >= 0)
+        {
+            left = m_left.GetNextStateByClass(pair.first, leftClass);
+        }
+        if (pair.second != NO_STATE && rightClass >= 0)
+        {
+            right = m_right.GetNextStateByClass(pair.second, rightClass);
+        }
+        return Normalize(left, right);
+    }
+
+    bool LazyProduct::IsDead(Pair pair) const
+    {
+        switch (m_operation)
+        {
+        case ProductOperation::Intersection:
+            return pair.first == NO_STATE || pair.second == NO_STATE;
+        case ProductOperation::Union:
+            return pair.first == NO_STATE && pair.second == NO_STATE;
+        default:
+            return pair.first == NO_STATE;
+        }
+    }
+
+    bool LazyProduct::IsAccepting(Pair pair) const
+    {
+        bool left = pair.first != NO_STATE && m_left.IsAccepting(pair.first);
+        bool right = pair.second != NO_STATE && m_right.IsAccepting(pair.second);
+        switch (m_operation)
+        {
+        case ProductOperation::Intersection:
+            return left && right;
+        case ProductOperation::Union:
+            return left || right;
+        default:
+            return left && !right;
+        }
+    }
+
+    void LazyProduct::ResetPairs()
+    {
+        m_pairIds.clear();
+        m_pairs.clear();
+    }
+
+    int LazyProduct::FindOrAdd(Pair pair)
+    {
+        uint64_t key = (uint64_t(uint32_t(pair.first)) << 32) | uint32_t(pair.second);
+        auto [it, inserted] = m_pairIds.try_emplace(key, int(m_pairs.size()));
+        if (inserted)
+        {
+            m_pairs.push_back(pair);
+        }
+        return it->second;
+    }
+}
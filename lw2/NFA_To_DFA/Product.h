@@ -0,0 +1,70 @@
+﻿#pragma once
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "Dfa.h"
+
+namespace Automata
+{
+    enum class ProductOperation
+    {
+        Intersection,
+        Union,
+        // Допускается левым и не допускается правым
+        Difference,
+    };
+
+    // Произведение двух DFA без построения полного декартова произведения: при проверке строки
+    // операнды идут шаг в шаг, при обходе создаются только достижимые пары.
+    // Состояния операндов, из которых не достичь заключительного, считаются отсутствующими (NO_STATE),
+    // поэтому пары, которые уже не могут ничего допустить, отсекаются сразу.
+    // Операнды должны жить дольше объекта.
+    class LazyProduct
+    {
+    public:
+        LazyProduct(const Dfa& left, const Dfa& right, ProductOperation operation);
+
+        bool Accepts(std::string_view input) const;
+        // Кратчайшая строка языка произведения, nullopt - язык пуст.
+        // Обход в ширину останавливается на первой заключительной паре.
+        std::optional<std::string> FindWitness();
+        bool IsEmpty();
+        // Все достижимые пары, нумерация в порядке обхода в ширину; больше maxStates - runtime_error
+        Dfa Materialize(size_t maxStates = std::numeric_limits<size_t>::max());
+
+        // Пары, созданные последним обходом
+        size_t GetExploredCount() const;
+
+    private:
+        using Pair = std::pair<int, int>;
+
+        static std::vector<char> FindUsefulStates(const Dfa& dfa);
+        Pair Normalize(int left, int right) const;
+        Pair Step(Pair pair, size_t productClass) const;
+        bool IsDead(Pair pair) const;
+        bool IsAccepting(Pair pair) const;
+        void ResetPairs();
+        int FindOrAdd(Pair pair);
+
+        const Dfa& m_left;
+        const Dfa& m_right;
+        ProductOperation m_operation;
+        // Объединение алфавитов по возрастанию. Символы с одинаковой парой классов операндов
+        // образуют класс произведения, обход перебирает только классы.
+        std::vector<char> m_symbols;
+        std::vector<int> m_symbolClass;
+        // Классы операндов (-1 - символа нет в алфавите) и первый символ каждого класса произведения
+        std::vector<Pair> m_classes;
+        std::vector<char> m_classSymbols;
+        std::vector<char> m_leftUseful;
+        std::vector<char> m_rightUseful;
+
+        std::unordered_map<uint64_t, int> m_pairIds;
+        std::vector<Pair> m_pairs;
+    };
+}
@@ -0,0 +1,277 @@
+﻿#include "Regex.h"
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+namespace
+{
+    const string_view SPECIAL_SYMBOLS = "|()*+?";
+
+    void Append(vector<int>& to, const vector<int>& from)
+    {
+        to.insert(to.end(), from.begin(), from.end());
+    }
+
+    invalid_argument SyntaxError(const string& message, size_t pos)
+    {
+        return invalid_argument("Regex error at " + to_string(pos) + ": " + message);
+    }
+}
+
+namespace Automata
+{
+    Regex::Regex(string_view pattern)
+    {
+        size_t pos = 0;
+        m_root = ParseAlternation(pattern, pos);
+        if (pos != pattern.size())
+        {
+            throw SyntaxError("unexpected ')'", pos);
+        }
+    }
+
+    size_t Regex::GetPositionCount() const
+    {
+        return m_positionCount;
+    }
+
+    Nfa Regex::BuildGlushkov() const
+    {
+        vector<char> symbols;
+        vector<vector<int>> follow;
+        PositionSets root = CollectPositions(m_root, symbols, follow);
+
+        // Переход в позицию помечен символом этой позиции
+        Nfa nfa;
+        nfa.AddState(root.nullable);
+        for (size_t position = 0; position < symbols.size(); position++)
+        {
+            nfa.AddState();
+        }
+        for (int position : root.last)
+        {
+            nfa.SetAccepting(position + 1);
+        }
+        for (int position : root.first)
+        {
+            nfa.AddTransition(0, symbols[position], position + 1);
+        }
+        for (size_t position = 0; position < follow.size(); position++)
+        {
+            auto& targets = follow[position];
+            sort(targets.begin(), targets.end());
+            targets.erase(unique(targets.begin(), targets.end()), targets.end());
+            for (int target : targets)
+            {
+                nfa.AddTransition(int(position) + 1, symbols[target], target + 1);
+            }
+        }
+
+        return nfa;
+    }
+
+    Nfa Regex::BuildThompson() const
+    {
+        Nfa nfa;
+        Fragment root = BuildFragment(m_root, nfa);
+        nfa.SetStart(root.start);
+        nfa.SetAccepting(root.end);
+        return nfa;
+    }
+
+    int Regex::ParseAlternation(string_view pattern, size_t& pos)
+    {
+        int node = ParseConcat(pattern, pos);
+        while (pos < pattern.size() && pattern[pos] == '|')
+        {
+            pos++;
+            node = AddNode(Kind::Alternation, 0, node, ParseConcat(pattern, pos));
+        }
+        return node;
+    }
+
+    int Regex::ParseConcat(string_view pattern, size_t& pos)
+    {
+        int node = -1;
+        while (pos < pattern.size() && pattern[pos] != '|' && pattern[pos] != ')')
+        {
+            int next = ParseRepeat(pattern, pos);
+            node = node == -1 ? next : AddNode(Kind::Concat, 0, node, next);
+        }
+        return node == -1 ? AddNode(Kind::Empty) : node;
+    }
+
+    int Regex::ParseRepeat(string_view pattern, size_t& pos)
+    {
+        int node;
+        char current = pattern[pos];
+        if (current == '(')
+        {
+            size_t open = pos++;
+            node = ParseAlternation(pattern, pos);
+            if (pos == pattern.size() || pattern[pos] != ')')
+            {
+                throw SyntaxError("unclosed '('", open);
+            }
+            pos++;
+        }
+        else if (current == '\\')
+        {
+            if (++pos == pattern.size())
+            {
+                throw SyntaxError("nothing to escape", pos - 1);
+            }
+            node = AddNode(Kind::Symbol, pattern[pos++]);
+        }
+        else if (SPECIAL_SYMBOLS.find(current) != string_view::npos)
+        {
+            throw SyntaxError(string("unexpected '") + current + "'", pos);
+        }
+        else
+        {
+            node = AddNode(Kind::Symbol, pattern[pos++]);
+        }
+
+        for (; pos < pattern.size(); pos++)
+        {
+            if (pattern[pos] == '*')
+            {
+                node = AddNode(Kind::Star, 0, node);
+            }
+            else if (pattern[pos] == '+')
+            {
+                node = AddNode(Kind::Plus, 0, node);
+            }
+            else if (pattern[pos] == '?')
+            {
+                node = AddNode(Kind::Optional, 0, node);
+            }
+            else
+            {
+                break;
+            }
+        }
+        return node;
+    }
+
+    int Regex::AddNode(Kind kind, char symbol, int left, int right)
+    {
+        if (kind == Kind::Symbol)
+        {
+            m_positionCount++;
+        }
+        m_nodes.push_back({ kind, symbol, left, right });
+        return int(m_nodes.size()) - 1;
+    }
+
+    // Nullable, First и Last поддерева; Follow дописывается в follow
+    Regex::PositionSets Regex::CollectPositions(int node, vector<char>& symbols, vector<vector<int>>& follow) const
+    {
+        const Node& current = m_nodes[node];
+        switch (current.kind)
+        {
+        case Kind::Empty:
+            return { true, {}, {} };
+        case Kind::Symbol:
+        {
+            int position = int(symbols.size());
+            symbols.push_back(current.symbol);
+            follow.emplace_back();
+            return { false, { position }, { position } };
+        }
+        case Kind::Concat:
+        {
+            PositionSets left = CollectPositions(current.left, symbols, follow);
+            PositionSets right = CollectPositions(current.right, symbols, follow);
+            for (int position : left.last)
+            {
+                Append(follow[position], right.first);
+            }
+            PositionSets result{ left.nullable && right.nullable, left.first, right.last };
+            if (left.nullable)
+            {
+                Append(result.first, right.first);
+            }
+            if (right.nullable)
+            {
+                Append(result.last, left.last);
+            }
+            return result;
+        }
+        case Kind::Alternation:
+        {
+            PositionSets left = CollectPositions(current.left, symbols, follow);
+            PositionSets right = CollectPositions(current.right, symbols, follow);
+            Append(left.first, right.first);
+            Append(left.last, right.last);
+            left.nullable = left.nullable || right.nullable;
+            return left;
+        }
+        default:
+        {
+            PositionSets inner = CollectPositions(current.left, symbols, follow);
+            if (current.kind != Kind::Optional)
+            {
+                for (int position : inner.last)
+                {
+                    Append(follow[position], inner.first);
+                }
+            }
+            inner.nullable = inner.nullable || current.kind != Kind::Plus;
+            return inner;
+        }
+        }
+    }
+
+    Regex::Fragment Regex::BuildFragment(int node, Nfa& nfa) const
+    {
+        const Node& current = m_nodes[node];
+        if (current.kind == Kind::Concat)
+        {
+            Fragment left = BuildFragment(current.left, nfa);
+            Fragment right = BuildFragment(current.right, nfa);
+            nfa.AddEpsilon(left.end, right.start);
+            return { left.start, right.end };
+        }
+
+        int start = nfa.AddState();
+        int end = nfa.AddState();
+        switch (current.kind)
+        {
+        case Kind::Empty:
+            nfa.AddEpsilon(start, end);
+            break;
+        case Kind::Symbol:
+            nfa.AddTransition(start, current.symbol, end);
+            break;
+        case Kind::Alternation:
+        {
+            Fragment left = BuildFragment(current.left, nfa);
+            Fragment right = BuildFragment(current.right, nfa);
+            nfa.AddEpsilon(start, left.start);
+            nfa.AddEpsilon(start, right.start);
+            nfa.AddEpsilon(left.end, end);
+            nfa.AddEpsilon(right.end, end);
+            break;
+        }
+        default:
+        {
+            Fragment inner = BuildFragment(current.left, nfa);
+            nfa.AddEpsilon(start, inner.start);
+            nfa.AddEpsilon(inner.end, end);
+            if (current.kind != Kind::Optional)
+            {
+                nfa.AddEpsilon(inner.end, inner.start);
+            }
+            if (current.kind != Kind::Plus)
+            {
+                nfa.AddEpsilon(start, end);
+            }
+            break;
+        }
+        }
+        return { start, end };
+    }
+}
@@ -0,0 +1,67 @@
+﻿#pragma once
+#include <string_view>
+#include <vector>
+#include "Nfa.h"
+
+namespace Automata
+{
+    // Регулярное выражение: литералы, конкатенация, |, *, +, ?, скобки; \ экранирует следующий символ.
+    class Regex
+    {
+    public:
+        explicit Regex(std::string_view pattern);
+
+        // Число позиций - вхождений символов в выражение
+        size_t GetPositionCount() const;
+
+        // Автомат позиций: состояние 0 и по одному на позицию, без эпсилон-переходов
+        Nfa BuildGlushkov() const;
+        // Автомат Томпсона с эпсилон-переходами
+        Nfa BuildThompson() const;
+
+    private:
+        enum class Kind
+        {
+            Empty,
+            Symbol,
+            Concat,
+            Alternation,
+            Star,
+            Plus,
+            Optional,
+        };
+
+        struct Node
+        {
+            Kind kind;
+            char symbol = 0;
+            int left = -1;
+            int right = -1;
+        };
+
+        struct PositionSets
+        {
+            bool nullable;
+            std::vector<int> first;
+            std::vector<int> last;
+        };
+
+        struct Fragment
+        {
+            int start;
+            int end;
+        };
+
+        int ParseAlternation(std::string_view pattern, size_t& pos);
+        int ParseConcat(std::string_view pattern, size_t& pos);
+        int ParseRepeat(std::string_view pattern, size_t& pos);
+        int AddNode(Kind kind, char symbol = 0, int left = -1, int right = -1);
+
+        PositionSets CollectPositions(int node, std::vector<char>& symbols, std::vector<std::vector<int>>& follow) const;
+        Fragment BuildFragment(int node, Nfa& nfa) const;
+
+        std::vector<Node> m_nodes;
+        int m_root = -1;
+        size_t m_positionCount = 0;
+    };
+}
@@ -0,0 +1,368 @@
+﻿#include "Reorder.h"
+#include "../../common/ParallelRun.h"
+#include <algorithm>
+#include <stdexcept>
+
+using namespace std;
+
+namespace Automata
+{
+    namespace
+    {
+        vector<int> GetBfsOrder(const Dfa& dfa)
+        {
+            const size_t stateCount = dfa.GetStateCount();
+            vector<char> visited(stateCount, false);
+            vector<int> order;
+            order.reserve(stateCount);
+
+            for (size_t root = 0; root < stateCount; root++)
+            {
+                if (visited[root])
+                {
+                    continue;
+                }
+                visited[root] = true;
+                order.push_back(int(root));
+                for (size_t i = order.size() - 1; i < order.size(); i++)
+                {
+                    for (size_t symbolClass = 0; symbolClass < dfa.GetClassCount(); symbolClass++)
+                    {
+                        int target = dfa.GetNextStateByClass(order[i], symbolClass);
+                        if (target != NO_STATE && !visited[target])
+                        {
+                            visited[target] = true;
+                            order.push_back(target);
+                        }
+                    }
+                }
+            }
+
+            return order;
+        }
+
+        // Граф без направлений: соседи по прямым и обратным переходам, без повторов
+        vector<int> GetCuthillMcKeeOrder(const Dfa& dfa)
+        {
+            const size_t stateCount = dfa.GetStateCount();
+            vector<vector<int>> neighbours(stateCount);
+            for (size_t state = 0; state < stateCount; state++)
+            {
+                for (size_t symbolClass = 0; symbolClass < dfa.GetClassCount(); symbolClass++)
+                {
+                    int target = dfa.GetNextStateByClass(int(state), symbolClass);
+                    if (target != NO_STATE && target != int(state))
+                    {
+                        neighbours[state].push_back(target);
+                        neighbours[target].push_back(int(state));
+                    }
+                }
+            }
+            for (auto& list : neighbours)
+            {
+                sort(list.begin(), list.end());
+                list.erase(unique(list.begin(), list.end()), list.end());
+            }
+            for (auto& list : neighbours)
+            {
+                stable_sort(list.begin(), list.end(), [&neighbours](int a, int b) {
+                    return neighbours[a].size() < neighbours[b].size();
+                });
+            }
+
+            // Начальное состояние первым, остальные компоненты - от вершины наименьшей степени
+            vector<int> roots(stateCount);
+            for (size_t state = 0; state < stateCount; state++)
+            {
+                roots[state] = int(state);
+            }
+            stable_sort(roots.begin() + (stateCount > 0 ? 1 : 0), roots.end(), [&neighbours](int a, int b) {
+                return neighbours[a].size() < neighbours[b].size();
+            });
+
+            vector<char> visited(stateCount, false);
+            vector<int> order;
+            order.reserve(stateCount);
+            for (int root : roots)
+            {
+                if (visited[root])
+                {
+                    continue;
+                }
+                visited[root] = true;
+                order.push_back(root);
+                for (size_t i = order.size() - 1; i < order.size(); i++)
+                {
+                    for (int next : neighbours[order[i]])
+                    {
+                        if (!visited[next])
+                        {
+                            visited[next] = true;
+                            order.push_back(next);
+                        }
+                    }
+                }
+            }
+
+            return order;
+        }
+
+        // Не посещённые на обучающем входе состояния идут в конец в порядке обхода в ширину
+        vector<int> GetProfileOrder(const Dfa& dfa, string_view trace)
+        {
+            const size_t stateCount = dfa.GetStateCount();
+            vector<size_t> visits(stateCount, 0);
+            int state = 0;
+            for (char symbol : trace)
+            {
+                state = dfa.GetNextStateBySymbol(state, symbol);
+                if (state == NO_STATE)
+                {
+                    state = 0;
+                }
+                visits[state]++;
+            }
+
+            vector<int> order = GetBfsOrder(dfa);
+            stable_sort(order.begin() + 1, order.end(), [&visits](int a, int b) {
+                return visits[a] > visits[b];
+            });
+            return order;
+        }
+    }
+
+    StateOrder ParseStateOrder(const string& order)
+    {
+        if (order == "bfs")
+        {
+            return StateOrder::Bfs;
+        }
+        if (order == "cm")
+        {
+            return StateOrder::CuthillMcKee;
+        }
+        if (order == "profile")
+        {
+            return StateOrder::Profile;
+        }
+        throw invalid_argument("State order should be bfs, cm or profile");
+    }
+
+    vector<int> GetStateOrder(const Dfa& dfa, StateOrder order, string_view trace)
+    {
+        if (dfa.GetStateCount() == 0)
+        {
+            return {};
+        }
+        switch (order)
+        {
+        case StateOrder::Bfs:
+            return GetBfsOrder(dfa);
+        case StateOrder::CuthillMcKee:
+            return GetCuthillMcKeeOrder(dfa);
+        default:
+            return GetProfileOrder(dfa, trace);
+        }
+    }
+
+    Dfa Renumber(const Dfa& dfa, const vector<int>& order)
+    {
+        const size_t stateCount = dfa.GetStateCount();
+        if (order.size() != stateCount || (stateCount > 0 && order[0] != 0))
+        {
+            throw invalid_argument("Order should be a permutation of DFA states starting with 0");
+        }
+
+        vector<int> newIds(stateCount, NO_STATE);
+        for (size_t i = 0; i < stateCount; i++)
+        {
+            newIds[order[i]] = int(i);
+        }
+
+        const auto& symbols = dfa.GetSymbols();
+        Dfa result(symbols);
+        for (size_t i = 0; i < stateCount; i++)
+        {
+            result.AddState(dfa.IsAccepting(order[i]));
+        }
+        for (size_t i = 0; i < stateCount; i++)
+        {
+            for (size_t symbol = 0; symbol < symbols.size(); symbol++)
+            {
+                int target = dfa.GetNextState(order[i], symbol);
+                result.SetTransition(int(i), symbol, target == NO_STATE ? NO_STATE : newIds[target]);
+            }
+        }
+        if (dfa.GetClassCount() < symbols.size())
+        {
+            result.CompressSymbols();
+        }
+        return result;
+    }
+
+    PackedDfa::PackedDfa(const Dfa& dfa, bool hugePages)
+        : m_classCount(dfa.GetClassCount())
+        , m_startAccepting(dfa.GetStateCount() > 0 && dfa.IsAccepting(0))
+        , m_next(dfa.GetStateCount() * dfa.GetClassCount(), hugePages)
+    {
+        if (dfa.GetStateCount() >= size_t(ACCEPT_BIT))
+        {
+            throw length_error("DFA is too large for a packed table");
+        }
+        for (int byte = 0; byte < 256; byte++)
+        {
+            int symbolIndex = dfa.GetSymbolIndex(char(byte));
+            m_byteClass[byte] = symbolIndex < 0 ? -1 : dfa.GetSymbolClass(symbolIndex);
+        }
+        for (size_t state = 0; state < dfa.GetStateCount(); state++)
+        {
+            for (size_t symbolClass = 0; symbolClass < m_classCount; symbolClass++)
+            {
+                int target = dfa.GetNextStateByClass(int(state), symbolClass);
+                m_next[state * m_classCount + symbolClass] = target == NO_STATE || !dfa.IsAccepting(target)
+                    ? target
+                    : target | ACCEPT_BIT;
+            }
+        }
+    }
+
+    bool PackedDfa::Accepts(string_view input) const
+    {
+        if (m_next.Size() == 0 && !m_startAccepting)
+        {
+            return false;
+        }
+
+        int cell = m_startAccepting ? ACCEPT_BIT : 0;
+        for (char symbol : input)
+        {
+            const int symbolClass = m_byteClass[static_cast<unsigned char>(symbol)];
+            if (symbolClass < 0)
+            {
+                return false;
+            }
+            cell = m_next[size_t(cell & ~ACCEPT_BIT) * m_classCount + symbolClass];
+            if (cell == NO_STATE)
+            {
+                return false;
+            }
+        }
+        return (cell & ACCEPT_BIT) != 0;
+    }
+
+    int PackedDfa::GetNextState(int state, char symbol) const
+    {
+        const int symbolClass = m_byteClass[static_cast<unsigned char>(symbol)];
+        int cell = symbolClass < 0 ? NO_STATE : m_next[size_t(state) * m_classCount + symbolClass];
+        return cell == NO_STATE ? 0 : cell & ~ACCEPT_BIT;
+    }
+
+    size_t PackedDfa::Scan(int& state, const char* input, size_t size) const
+    {
+        size_t matches = 0;
+        for (size_t i = 0; i < size; i++)
+        {
+            const int symbolClass = m_byteClass[static_cast<unsigned char>(input[i])];
+            int cell = symbolClass < 0 ? NO_STATE : m_next[size_t(state) * m_classCount + symbolClass];
+            if (cell == NO_STATE)
+            {
+                state = 0;
+                continue;
+            }
+            matches += (cell & ACCEPT_BIT) != 0;
+            state = cell & ~ACCEPT_BIT;
+        }
+        return matches;
+    }
+
+    // Тупиков нет (из них возврат в начальное состояние), поэтому после схождения запусков
+    // совпадения куска не зависят от его начального состояния
+    size_t PackedDfa::CountMatches(string_view input, size_t threadCount) const
+    {
+        if (m_next.Size() == 0)
+        {
+            return 0;
+        }
+        if (threadCount == 0)
+        {
+            threadCount = GetHardwareThreadCount();
+        }
+        const size_t chunkCount = min(threadCount, input.size() / MIN_PARALLEL_CHUNK);
+        if (chunkCount <= 1)
+        {
+            int state = 0;
+            return Scan(state, input.data(), input.size());
+        }
+
+        struct Chunk
+        {
+            size_t begin = 0;
+            size_t size = 0;
+            StateMapping mapping;
+            // Состояние в конце и совпадения после схождения
+            int state = 0;
+            size_t matches = 0;
+        };
+        vector<Chunk> chunks(chunkCount);
+        for (size_t i = 0; i < chunkCount; i++)
+        {
+            chunks[i].begin = input.size() * i / chunkCount;
+            chunks[i].size = input.size() * (i + 1) / chunkCount - chunks[i].begin;
+        }
+
+        const size_t stateCount = m_next.Size() / m_classCount;
+        ParallelFor(chunkCount, chunkCount, [&](size_t, size_t first, size_t last) {
+            for (size_t i = first; i < last; i++)
+            {
+                Chunk& chunk = chunks[i];
+                const char* begin = input.data() + chunk.begin;
+                if (i == 0)
+                {
+                    chunk.matches = Scan(chunk.state, begin, chunk.size);
+                    continue;
+                }
+                chunk.mapping = MapStates(stateCount, begin, chunk.size, [this](int state, char symbol) {
+                    return GetNextState(state, symbol);
+                });
+                chunk.state = chunk.mapping.stateAt[0];
+                chunk.matches = Scan(chunk.state, begin + chunk.mapping.convergedAt, chunk.size - chunk.mapping.convergedAt);
+            }
+        });
+
+        vector<int> starts(chunkCount, 0);
+        for (size_t i = 1; i < chunkCount; i++)
+        {
+            starts[i] = chunks[i - 1].state;
+            if (chunks[i].mapping.convergedAt == chunks[i].size)
+            {
+                chunks[i].state = chunks[i].mapping.stateAt[starts[i]];
+            }
+        }
+
+        // Совпадения до схождения - от настоящего начального состояния
+        ParallelFor(chunkCount - 1, chunkCount - 1, [&](size_t, size_t first, size_t last) {
+            for (size_t i = first + 1; i <= last; i++)
+            {
+                int state = starts[i];
+                chunks[i].matches += Scan(state, input.data() + chunks[i].begin, chunks[i].mapping.convergedAt);
+            }
+        });
+
+        size_t matches = 0;
+        for (const auto& chunk : chunks)
+        {
+            matches += chunk.matches;
+        }
+        return matches;
+    }
+
+    size_t PackedDfa::GetMemoryUsage() const
+    {
+        return sizeof(m_byteClass) + m_next.Size() * sizeof(int);
+    }
+
+    bool PackedDfa::IsHugePages() const
+    {
+        return m_next.IsHugePages();
+    }
+}
@@ -0,0 +1,56 @@
+﻿#pragma once
+#include <array>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "Dfa.h"
+#include "../../common/PageArray.h"
+
+namespace Automata
+{
+    enum class StateOrder
+    {
+        // Обход в ширину по классам символов
+        Bfs,
+        // Каттхилл - Макки: соседи добавляются по возрастанию степени, ширина ленты таблицы меньше
+        CuthillMcKee,
+        // По убыванию числа посещений на обучающем входе
+        Profile,
+    };
+
+    StateOrder ParseStateOrder(const std::string& order);
+
+    // Перестановка order[newState] = oldState, начальное состояние всегда остаётся 0.
+    // trace используется только для Profile: переход в тупик возвращает в начальное состояние.
+    std::vector<int> GetStateOrder(const Dfa& dfa, StateOrder order, std::string_view trace = {});
+    Dfa Renumber(const Dfa& dfa, const std::vector<int>& order);
+
+    // Таблица для цикла сканирования: строки по классам символов подряд, заключительность
+    // в старшем бите ячейки, чтобы проверка не трогала вторую таблицу.
+    class PackedDfa
+    {
+    public:
+        PackedDfa(const Dfa& dfa, bool hugePages);
+
+        bool Accepts(std::string_view input) const;
+        // Число позиций входа, после которых автомат в заключительном состоянии; из тупика - в начальное.
+        // При threadCount > 1 куски входа считаются параллельно через MapStates, 0 - по числу ядер.
+        size_t CountMatches(std::string_view input, size_t threadCount = 1) const;
+
+        size_t GetMemoryUsage() const;
+        bool IsHugePages() const;
+
+    private:
+        static constexpr int ACCEPT_BIT = 1 << 30;
+        static constexpr size_t MIN_PARALLEL_CHUNK = 1 << 16;
+
+        int GetNextState(int state, char symbol) const;
+        size_t Scan(int& state, const char* input, size_t size) const;
+
+        std::array<int, 256> m_byteClass;
+        size_t m_classCount = 0;
+        bool m_startAccepting = false;
+        // Цель перехода с флагом ACCEPT_BIT или NO_STATE
+        PageArray<int> m_next;
+    };
+}
@@ -0,0 +1,333 @@
+﻿#include "SubsetEngine.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+using namespace std;
+
+namespace
+{
+    // Оценка размера DFA делается после разворота стольких состояний
+    const size_t ESTIMATE_SAMPLE_STATES = 1024;
+
+    uint64_t HashStates(const int* states, size_t size)
+    {
+        uint64_t hash = 0xcbf29ce484222325ULL ^ size;
+        for (size_t i = 0; i < size; i++)
+        {
+            hash ^= uint32_t(states[i]);
+            hash *= 0x100000001b3ULL;
+            hash ^= hash >> 29;
+        }
+        return hash;
+    }
+}
+
+namespace Automata
+{
+    Dfa SubsetEngine::Determinize(const Nfa& nfa)
+    {
+        return Determinize(CsrNfa(nfa));
+    }
+
+    Dfa SubsetEngine::Determinize(const Nfa& nfa, const DeterminizeOptions& options, DeterminizeReport& report)
+    {
+        return Determinize(CsrNfa(nfa), options, report);
+    }
+
+    Dfa SubsetEngine::Determinize(const CsrNfa& nfa)
+    {
+        DeterminizeReport report;
+        return Determinize(nfa, {}, report);
+    }
+
+    Dfa SubsetEngine::Determinize(const CsrNfa& nfa, const DeterminizeOptions& options, DeterminizeReport& report)
+    {
+        Reset(nfa);
+        report = {};
+        vector<char> alphabet = options.alphabet.empty() ? nfa.GetAlphabet() : options.alphabet;
+        Dfa dfa(alphabet);
+        if (nfa.GetStateCount() == 0)
+        {
+            return dfa;
+        }
+
+        m_symbolIndex.assign(256, -1);
+        for (size_t i = 0; i < alphabet.size(); i++)
+        {
+            m_symbolIndex[static_cast<unsigned char>(alphabet[i])] = int(i);
+        }
+
+        vector<int> subset{ nfa.GetStart() };
+        NextGeneration();
+        Mark(nfa.GetStart());
+        AddClosure(nfa, subset);
+        FindOrAdd(subset, numeric_limits<size_t>::max());
+        m_subsetLevels.assign(1, 0);
+
+        // Новые подмножества дописываются в конец, поэтому обход идёт по номерам
+        size_t current = 0;
+        bool overflow = false;
+        for (; current < GetSubsetCount(); current++)
+        {
+            report.peakBytes = max(report.peakBytes, GetMemoryUsage(alphabet.size()));
+            if (current == ESTIMATE_SAMPLE_STATES)
+            {
+                report.estimatedStates = EstimateStates(nfa, current);
+                if (options.stopOnEstimate && report.estimatedStates > double(options.maxStates))
+                {
+                    break;
+                }
+            }
+            if (report.peakBytes > options.maxBytes)
+            {
+                break;
+            }
+
+            bool accepting = false;
+            auto currentSubset = GetSubset(int(current));
+            for (int state : currentSubset)
+            {
+                accepting = accepting || nfa.IsAccepting(state);
+            }
+            dfa.AddState(accepting);
+            nfa.Move(currentSubset, m_symbolIndex, alphabet.size(), m_move);
+
+            for (size_t symbol = 0; symbol < alphabet.size(); symbol++)
+            {
+                const uint32_t begin = m_move.offsets[symbol];
+                const uint32_t end = m_move.offsets[symbol + 1];
+                if (begin == end)
+                {
+                    continue;
+                }
+
+                NextGeneration();
+                subset.clear();
+                for (uint32_t i = begin; i < end; i++)
+                {
+                    int state = m_move.targets[i];
+                    if (Mark(state))
+                    {
+                        subset.push_back(state);
+                    }
+                }
+                AddClosure(nfa, subset);
+                size_t countBefore = GetSubsetCount();
+                int target = FindOrAdd(subset, options.maxStates);
+                if (target == NO_STATE)
+                {
+                    overflow = true;
+                    break;
+                }
+                if (GetSubsetCount() != countBefore)
+                {
+                    m_subsetLevels.push_back(m_subsetLevels[current] + 1);
+                }
+                dfa.SetTransition(int(current), symbol, target);
+            }
+
+            // Новое подмножество не влезло в бюджет: состояние остаётся неразвёрнутым
+            if (overflow)
+            {
+                for (size_t symbol = 0; symbol < alphabet.size(); symbol++)
+                {
+                    dfa.SetTransition(int(current), symbol, NO_STATE);
+                }
+                break;
+            }
+        }
+
+        report.expandedStates = current;
+        report.complete = current == GetSubsetCount();
+        if (report.complete)
+        {
+            report.estimatedStates = double(current);
+        }
+        else if (report.estimatedStates == 0)
+        {
+            report.estimatedStates = EstimateStates(nfa, current);
+        }
+
+        // Найденные, но не развёрнутые состояния
+        for (size_t state = dfa.GetStateCount(); state < GetSubsetCount(); state++)
+        {
+            bool accepting = false;
+            for (int nfaState : GetSubset(int(state)))
+            {
+                accepting = accepting || nfa.IsAccepting(nfaState);
+            }
+            dfa.AddState(accepting);
+        }
+
+        return dfa;
+    }
+
+    span<const int> SubsetEngine::GetSubset(int dfaState) const
+    {
+        size_t begin = m_subsetOffsets[dfaState];
+        return { m_subsetData.data() + begin, m_subsetOffsets[dfaState + 1] - begin };
+    }
+
+    size_t SubsetEngine::GetSubsetCount() const
+    {
+        return m_subsetOffsets.size() - 1;
+    }
+
+    void SubsetEngine::Reset(const CsrNfa& nfa)
+    {
+        if (nfa.GetStateCount() > 0 && (nfa.GetStart() < 0 || nfa.GetStart() >= int(nfa.GetStateCount())))
+        {
+            throw invalid_argument("NFA has no start state");
+        }
+
+        m_subsetData.clear();
+        m_subsetOffsets.assign(1, 0);
+        m_subsetHashes.clear();
+        m_table.assign(64, NO_STATE);
+        m_marks.assign(nfa.GetStateCount(), 0);
+        m_generation = 0;
+    }
+
+    void SubsetEngine::NextGeneration()
+    {
+        if (++m_generation == 0)
+        {
+            fill(m_marks.begin(), m_marks.end(), 0);
+            m_generation = 1;
+        }
+    }
+
+    bool SubsetEngine::Mark(int state)
+    {
+        if (m_marks[state] == m_generation)
+        {
+            return false;
+        }
+        m_marks[state] = m_generation;
+        return true;
+    }
+
+    // Дополняет помеченные состояния эпсилон-замыканием и сортирует
+    void SubsetEngine::AddClosure(const CsrNfa& nfa, vector<int>& states)
+    {
+        if (nfa.HasEpsilon())
+        {
+            m_stack.assign(states.begin(), states.end());
+            while (!m_stack.empty())
+            {
+                int state = m_stack.back();
+                m_stack.pop_back();
+                for (int target : nfa.GetEpsilonEdges(state))
+                {
+                    if (Mark(target))
+                    {
+                        states.push_back(target);
+                        m_stack.push_back(target);
+                    }
+                }
+            }
+        }
+        sort(states.begin(), states.end());
+    }
+
+    // Нового подмножества сверх maxCount не добавляет и возвращает NO_STATE
+    int SubsetEngine::FindOrAdd(const vector<int>& subset, size_t maxCount)
+    {
+        const uint64_t hash = HashStates(subset.data(), subset.size());
+        const size_t mask = m_table.size() - 1;
+        size_t slot = size_t(hash) & mask;
+        for (; m_table[slot] != NO_STATE; slot = (slot + 1) & mask)
+        {
+            int id = m_table[slot];
+            if (m_subsetHashes[id] == hash)
+            {
+                auto existing = GetSubset(id);
+                if (equal(existing.begin(), existing.end(), subset.begin(), subset.end()))
+                {
+                    return id;
+                }
+            }
+        }
+
+        if (GetSubsetCount() >= maxCount)
+        {
+            return NO_STATE;
+        }
+
+        int id = int(GetSubsetCount());
+        m_table[slot] = id;
+        m_subsetHashes.push_back(hash);
+        m_subsetData.insert(m_subsetData.end(), subset.begin(), subset.end());
+        m_subsetOffsets.push_back(m_subsetData.size());
+        if (GetSubsetCount() * 2 > m_table.size())
+        {
+            Rehash();
+        }
+        return id;
+    }
+
+    void SubsetEngine::Rehash()
+    {
+        m_table.assign(m_table.size() * 2, NO_STATE);
+        const size_t mask = m_table.size() - 1;
+        for (size_t id = 0; id < m_subsetHashes.size(); id++)
+        {
+            size_t slot = size_t(m_subsetHashes[id]) & mask;
+            while (m_table[slot] != NO_STATE)
+            {
+                slot = (slot + 1) & mask;
+            }
+            m_table[slot] = int(id);
+        }
+    }
+
+    size_t SubsetEngine::GetMemoryUsage(size_t symbolCount) const
+    {
+        return m_subsetData.capacity() * sizeof(int)
+            + m_subsetOffsets.capacity() * sizeof(size_t)
+            + m_subsetHashes.capacity() * sizeof(uint64_t)
+            + m_subsetLevels.capacity() * sizeof(int)
+            + m_table.capacity() * sizeof(int)
+            + GetSubsetCount() * symbolCount * sizeof(int);
+    }
+
+    // Рост последнего полного уровня обхода продолжается ещё на столько же уровней,
+    // сколько уже пройдено (но не глубже числа состояний NFA), итог ограничен 2^n.
+    double SubsetEngine::EstimateStates(const CsrNfa& nfa, size_t expanded) const
+    {
+        const int lastLevel = m_subsetLevels[expanded == 0 ? 0 : expanded - 1];
+        vector<double> levelSizes(m_subsetLevels.back() + 1, 0);
+        for (int level : m_subsetLevels)
+        {
+            levelSizes[level]++;
+        }
+
+        double estimate = double(GetSubsetCount());
+        const double limit = pow(2.0, min<double>(double(nfa.GetStateCount()), 1000));
+        if (lastLevel < 1 || levelSizes[lastLevel - 1] == 0)
+        {
+            return estimate;
+        }
+
+        const double growth = levelSizes[lastLevel] / levelSizes[lastLevel - 1];
+        double levelSize = levelSizes.back();
+        const size_t depth = min(nfa.GetStateCount(), 2 * levelSizes.size());
+        for (size_t level = levelSizes.size(); level < depth && estimate < limit; level++)
+        {
+            levelSize *= growth;
+            if (levelSize < 1)
+            {
+                break;
+            }
+            estimate += levelSize;
+        }
+        return min(estimate, limit);
+    }
+
+    Dfa Determinize(const Nfa& nfa)
+    {
+        SubsetEngine engine;
+        return engine.Determinize(nfa);
+    }
+}
@@ -0,0 +1,78 @@
+﻿#pragma once
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+#include "CsrNfa.h"
+#include "Dfa.h"
+#include "Nfa.h"
+
+namespace Automata
+{
+    struct DeterminizeOptions
+    {
+        // Порядок символов в DFA; пусто - все символы NFA по возрастанию.
+        // Переходы по символам вне списка игнорируются.
+        std::vector<char> alphabet;
+        // Состояний DFA не больше maxStates; начальное создаётся всегда
+        size_t maxStates = std::numeric_limits<size_t>::max();
+        size_t maxBytes = std::numeric_limits<size_t>::max();
+        // Остановиться сразу, если оценка по первым уровням обхода превышает maxStates
+        bool stopOnEstimate = false;
+    };
+
+    struct DeterminizeReport
+    {
+        bool complete = true;
+        // Состояния DFA с построенными переходами, это первые номера
+        size_t expandedStates = 0;
+        size_t peakBytes = 0;
+        // Оценка размера полного DFA по росту уровней обхода в ширину
+        double estimatedStates = 0;
+    };
+
+    // Построение подмножеств. Всё состояние алгоритма хранится в объекте и переиспользуется
+    // между вызовами; разные потоки работают каждый со своим SubsetEngine над общим const Nfa.
+    class SubsetEngine
+    {
+    public:
+        // Состояния DFA нумеруются в порядке обхода в ширину, пустое подмножество не создаётся
+        Dfa Determinize(const CsrNfa& nfa);
+        // При превышении бюджета построение останавливается: состояния с номерами
+        // от report.expandedStates найдены, но их переходы не построены
+        Dfa Determinize(const CsrNfa& nfa, const DeterminizeOptions& options, DeterminizeReport& report);
+        // Автомат сначала упаковывается в CsrNfa
+        Dfa Determinize(const Nfa& nfa);
+        Dfa Determinize(const Nfa& nfa, const DeterminizeOptions& options, DeterminizeReport& report);
+
+        // Состояния NFA, из которых собрано состояние DFA последнего построения, по возрастанию
+        std::span<const int> GetSubset(int dfaState) const;
+        size_t GetSubsetCount() const;
+
+    private:
+        void Reset(const CsrNfa& nfa);
+        void NextGeneration();
+        bool Mark(int state);
+        void AddClosure(const CsrNfa& nfa, std::vector<int>& states);
+        int FindOrAdd(const std::vector<int>& subset, size_t maxCount);
+        void Rehash();
+        size_t GetMemoryUsage(size_t symbolCount) const;
+        double EstimateStates(const CsrNfa& nfa, size_t expanded) const;
+
+        // Подмножества подряд: m_subsetData[m_subsetOffsets[i]..m_subsetOffsets[i + 1])
+        std::vector<int> m_subsetData;
+        std::vector<size_t> m_subsetOffsets{ 0 };
+        std::vector<uint64_t> m_subsetHashes;
+        std::vector<int> m_subsetLevels;
+        // Открытая адресация: номер подмножества или NO_STATE
+        std::vector<int> m_table;
+
+        std::vector<int> m_symbolIndex;
+        SubsetMove m_move;
+        std::vector<uint32_t> m_marks;
+        uint32_t m_generation = 0;
+        std::vector<int> m_stack;
+    };
+
+    Dfa Determinize(const Nfa& nfa);
+}
@@ -0,0 +1,115 @@
+﻿#include "../grammar_to_dfa/DFA.h"
+#include "../../common/StaticAutomaton.h"
+#include "generated_direct.h"
+#include "generated_table.h"
+#include <chrono>
+#include <random>
+
+namespace
+{
+	using namespace std;
+
+	const string GRAMMAR_FILE_NAME = "bench_grammar.txt";
+	const size_t DEFAULT_INPUT_COUNT = 200000;
+	const size_t MAX_INPUT_LENGTH = 64;
+
+	// Та же грамматика, что в bench_grammar.txt, построенная во время компиляции
+	constexpr auto STATIC_MATCHER = ParseStaticGrammar<R"(
+S -> aA | bB | cS
+A -> aA | bC | c
+B -> bB | aC | cS
+C -> aS | bA | cD | a
+D -> dD | d | aB
+)">();
+
+	// Половина строк - случайные блуждания по автомату (обычно допускаются),
+	// половина - случайные символы алфавита (обычно отвергаются рано).
+	vector<string> GenerateInputs(const CodegenTable& table, size_t count)
+	{
+		mt19937 random(42);
+		const size_t symbolCount = table.symbols.size();
+		vector<string> inputs;
+		inputs.reserve(count);
+
+		for (size_t i = 0; i < count; i++)
+		{
+			string input;
+			size_t length = random() % (MAX_INPUT_LENGTH + 1);
+			int state = table.startState;
+			for (size_t j = 0; j < length; j++)
+			{
+				size_t symbol = random() % symbolCount;
+				if (i % 2 == 0)
+				{
+					for (size_t k = 0; k < symbolCount && table.next[state * symbolCount + symbol] < 0; k++)
+					{
+						symbol = (symbol + 1) % symbolCount;
+					}
+					if (table.next[state * symbolCount + symbol] < 0)
+					{
+						break;
+					}
+					state = table.next[state * symbolCount + symbol];
+				}
+				input += table.symbols[symbol];
+			}
+			inputs.push_back(move(input));
+		}
+
+		return inputs;
+	}
+
+	template <class Matcher>
+	void Measure(const string& name, const vector<string>& inputs, vector<bool>& results, Matcher&& match)
+	{
+		auto start = chrono::steady_clock::now();
+		size_t accepted = 0;
+		for (size_t i = 0; i < inputs.size(); i++)
+		{
+			results[i] = match(inputs[i]);
+			accepted += results[i];
+		}
+		auto elapsed = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+		cout << name << ": " << elapsed << " ms, accepted " << accepted << " of " << inputs.size() << endl;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	try
+	{
+		size_t count = argc > 1 ? stoul(argv[1]) : DEFAULT_INPUT_COUNT;
+		Grammar grammar(GRAMMAR_FILE_NAME, Grammar::Side::Right);
+		DFA dfa(grammar);
+		dfa.Minimize();
+
+		vector<string> inputs = GenerateInputs(dfa.GetCodegenTable("bench"), count);
+		vector<bool> interpreted(count), direct(count), table(count), constant(count);
+
+		Measure("interpreted", inputs, interpreted, [&](const string& input) {
+			return dfa.Accepts(input);
+		});
+		Measure("direct", inputs, direct, [](const string& input) {
+			return direct_matcher::Match(input.data(), input.data() + input.size());
+		});
+		Measure("table", inputs, table, [](const string& input) {
+			return table_matcher::Match(input.data(), input.data() + input.size());
+		});
+		Measure("constexpr", inputs, constant, [](const string& input) {
+			return STATIC_MATCHER.Accepts(input);
+		});
+
+		if (direct != interpreted || table != interpreted || constant != interpreted)
+		{
+			cout << "Generated matchers disagree with the interpreted DFA" << endl;
+			return EXIT_FAILURE;
+		}
+	}
+	catch (const exception& e)
+	{
+		cout << e.what() << endl;
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,275 @@
+﻿#include "NfaTable.h"
+#include "../../common/MappedFile.h"
+#include <algorithm>
+#include <climits>
+#include <stdexcept>
+
+using namespace std;
+
+namespace
+{
+    const char OPEN_SYMBOL = '[';
+    const char CLOSE_SYMBOL = ']';
+
+    class Parser
+    {
+    public:
+        Parser(const char* data, size_t size, const string& fileName)
+            : m_data(data)
+            , m_size(size)
+            , m_fileName(fileName)
+        {
+        }
+
+        bool AtEnd() const
+        {
+            return m_pos == m_size;
+        }
+
+        size_t GetSize() const
+        {
+            return m_size;
+        }
+
+        // Смещение следующего непробельного символа строки
+        size_t GetPosition()
+        {
+            SkipSpaces();
+            return m_pos;
+        }
+
+        // Пробелы внутри строки, перевод строки не пропускается
+        void SkipSpaces()
+        {
+            while (m_pos < m_size && (m_data[m_pos] == ' ' || m_data[m_pos] == '\t' || m_data[m_pos] == '\r'))
+            {
+                m_pos++;
+            }
+        }
+
+        bool AtLineEnd()
+        {
+            SkipSpaces();
+            return AtEnd() || m_data[m_pos] == '\n';
+        }
+
+        void SkipLine()
+        {
+            while (m_pos < m_size && m_data[m_pos++] != '\n')
+            {
+            }
+        }
+
+        void SkipEmptyLines()
+        {
+            while (AtLineEnd() && !AtEnd())
+            {
+                m_pos++;
+            }
+        }
+
+        void EndLine()
+        {
+            if (!AtLineEnd())
+            {
+                Fail("unexpected '" + string(1, m_data[m_pos]) + "'");
+            }
+            if (!AtEnd())
+            {
+                m_pos++;
+            }
+        }
+
+        // Текст заголовка до '[' пропускается
+        void SkipToOpen()
+        {
+            while (m_pos < m_size && m_data[m_pos] != OPEN_SYMBOL && m_data[m_pos] != '\n')
+            {
+                m_pos++;
+            }
+            Expect(OPEN_SYMBOL);
+        }
+
+        bool TrySkip(char symbol)
+        {
+            SkipSpaces();
+            if (m_pos < m_size && m_data[m_pos] == symbol)
+            {
+                m_pos++;
+                return true;
+            }
+            return false;
+        }
+
+        void Expect(char symbol)
+        {
+            if (!TrySkip(symbol))
+            {
+                Fail(string("expected '") + symbol + "'");
+            }
+        }
+
+        char ReadSymbol()
+        {
+            return m_data[m_pos++];
+        }
+
+        int ReadInt()
+        {
+            SkipSpaces();
+            bool negative = m_pos < m_size && m_data[m_pos] == '-';
+            size_t start = m_pos + (negative ? 1 : 0);
+            size_t end = start;
+            long long value = 0;
+            while (end < m_size && m_data[end] >= '0' && m_data[end] <= '9')
+            {
+                value = value * 10 + (m_data[end] - '0');
+                if (value > INT_MAX)
+                {
+                    Fail("number is too large");
+                }
+                end++;
+            }
+            if (end == start)
+            {
+                Fail("expected number");
+            }
+            m_pos = end;
+            return int(negative ? -value : value);
+        }
+
+        // Список чисел через запятую до ']', positions - смещения чисел
+        void ReadList(vector<int>& values, vector<size_t>* positions = nullptr)
+        {
+            if (TrySkip(CLOSE_SYMBOL))
+            {
+                return;
+            }
+            do
+            {
+                if (positions != nullptr)
+                {
+                    positions->push_back(GetPosition());
+                }
+                values.push_back(ReadInt());
+            } while (TrySkip(','));
+            Expect(CLOSE_SYMBOL);
+        }
+
+        // Номер состояния в 1..totalStates, position - смещение числа в файле
+        void CheckState(int state, int totalStates, size_t position) const
+        {
+            if (state < 1 || state > totalStates)
+            {
+                FailAt(position, "state " + to_string(state) + " is out of range 1.." + to_string(totalStates));
+            }
+        }
+
+        [[noreturn]] void Fail(const string& message) const
+        {
+            FailAt(m_pos, message);
+        }
+
+        [[noreturn]] void FailAt(size_t position, const string& message) const
+        {
+            throw runtime_error("Malformed NFA file " + m_fileName + " at byte " + to_string(position) + ": " + message);
+        }
+
+    private:
+        const char* m_data;
+        size_t m_size;
+        size_t m_pos = 0;
+        const string& m_fileName;
+    };
+}
+
+// Формат:
+// init: [1]
+// final: [2,3]
+// total: [3]
+// a b E
+// 1 [2] [] [1,3]
+// ...
+// Номер в начале строки таблицы пропускается, строки нумеруются по порядку.
+NfaTable ReadNfaTable(const string& fileName)
+{
+    MappedFile file(fileName);
+    Parser parser(file.Data(), file.Size(), fileName);
+    NfaTable table;
+
+    // Начальное и заключительные состояния проверяются, когда известно число состояний
+    parser.SkipToOpen();
+    const size_t initPosition = parser.GetPosition();
+    table.initState = parser.ReadInt();
+    parser.Expect(CLOSE_SYMBOL);
+    parser.SkipLine();
+
+    parser.SkipToOpen();
+    vector<size_t> finalPositions;
+    parser.ReadList(table.finalStates, &finalPositions);
+    parser.SkipLine();
+
+    parser.SkipToOpen();
+    const size_t totalPosition = parser.GetPosition();
+    table.totalStates = parser.ReadInt();
+    if (table.totalStates < 0)
+    {
+        parser.Fail("negative state count");
+    }
+    parser.Expect(CLOSE_SYMBOL);
+    parser.SkipLine();
+
+    parser.CheckState(table.initState, table.totalStates, initPosition);
+    for (size_t i = 0; i < table.finalStates.size(); i++)
+    {
+        parser.CheckState(table.finalStates[i], table.totalStates, finalPositions[i]);
+    }
+
+    while (!parser.AtLineEnd())
+    {
+        table.alphabet.push_back(parser.ReadSymbol());
+    }
+    parser.EndLine();
+
+    // Строка таблицы занимает хотя бы номер и "[]" на каждый столбец: число состояний
+    // не по размеру файла отвергается до резервирования памяти
+    const size_t columnCount = table.alphabet.size();
+    const size_t rest = parser.GetSize() - parser.GetPosition();
+    if (size_t(table.totalStates) > rest / (1 + 2 * columnCount))
+    {
+        parser.FailAt(totalPosition, "state count " + to_string(table.totalStates) + " does not fit in the file");
+    }
+    table.offsets.reserve(size_t(table.totalStates) * columnCount + 1);
+    table.offsets.push_back(0);
+    table.targets.reserve(parser.GetSize() / 4);
+    vector<size_t> cellPositions;
+    for (int row = 0; row < table.totalStates; row++)
+    {
+        parser.SkipEmptyLines();
+        if (parser.AtEnd())
+        {
+            parser.Fail("expected " + to_string(table.totalStates) + " state rows, found " + to_string(row));
+        }
+        parser.ReadInt();
+        for (size_t column = 0; column < columnCount; column++)
+        {
+            parser.Expect(OPEN_SYMBOL);
+            size_t cellStart = table.targets.size();
+            cellPositions.clear();
+            parser.ReadList(table.targets, &cellPositions);
+            for (size_t i = 0; i < cellPositions.size(); i++)
+            {
+                parser.CheckState(table.targets[cellStart + i], table.totalStates, cellPositions[i]);
+            }
+            sort(table.targets.begin() + cellStart, table.targets.end());
+            if (table.targets.size() > UINT32_MAX)
+            {
+                parser.Fail("too many transitions");
+            }
+            table.offsets.push_back(uint32_t(table.targets.size()));
+        }
+        parser.EndLine();
+    }
+
+    return table;
+}
@@ -0,0 +1,20 @@
+﻿#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Автомат из файла. Строка таблицы row - состояние row + 1, столбцы - символы alphabet
+// (столбец 'E' - эпсилон-переходы). Переходы ячейки лежат подряд в targets:
+// targets[offsets[cell]..offsets[cell + 1]), cell = row * alphabet.size() + column.
+struct NfaTable
+{
+    int initState = 0;
+    std::vector<int> finalStates;
+    int totalStates = 0;
+    std::vector<char> alphabet;
+    std::vector<uint32_t> offsets;
+    std::vector<int> targets;
+};
+
+// Один проход по отображённому в память файлу; при ошибке формата runtime_error со смещением в байтах
+NfaTable ReadNfaTable(const std::string& fileName);
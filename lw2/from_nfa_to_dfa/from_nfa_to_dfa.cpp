@@ -1,14 +1,24 @@
 ﻿#include <iostream>
 #include <fstream>
-#include <sstream>
 #include <string>
 #include <vector>
 #include <map>
-#include <stack>
 #include <utility>
 #include <algorithm>
 #include <optional>
 #include <stdexcept>
+#include <chrono>
+#include <random>
+#include "../../common/Trim.h"
+#include "../NFA_To_DFA/BitParallelNfa.h"
+#include "../NFA_To_DFA/CombDfa.h"
+#include "../NFA_To_DFA/HybridExecutor.h"
+#include "../NFA_To_DFA/Minimize.h"
+#include "../NFA_To_DFA/MultiPattern.h"
+#include "../NFA_To_DFA/Regex.h"
+#include "../NFA_To_DFA/Reorder.h"
+#include "../NFA_To_DFA/SubsetEngine.h"
+#include "NfaTable.h"
 
 // скрестить с минимизацией
 // добавить отображение финальных состояний + не менять цифры
@@ -26,7 +36,6 @@ struct DFAState
 };
 
 using DFA = map<int, DFAState>;
-using NFA = map<int, map<char, vector<int>>>;
 
 bool HasVector(const vector<int>& vector, int num)
 {
@@ -52,365 +61,648 @@ void PrintVector(vector<int> vector)
     cout << "]";
 }
 
-optional<int> FindUnmarked(const DFA& dfa)
+vector<int> GetDFAFinalStates(const DFA& dfa, const vector<int>& finalStates)
 {
-    size_t size = dfa.size();
-    for (size_t i = 0; i < size; i++)
+    vector<int> finals;
+    for (const auto& [stateID, dfaState] : dfa)
     {
-        const DFAState& current = dfa.at(i);
-        if (!current.marked)
+        for (auto const& el : finalStates)
         {
-            return i;
+            if (HasVector(dfaState.states, el))
+            {
+                finals.push_back(stateID);
+            }
         }
     }
 
-    return nullopt;
+    return finals;
 }
 
-optional<int> FindState(const vector<int>& state, const DFA& dfa)
+void VisualizeDFA(const DFA& dfa, const vector<char>& alphabet)
 {
-    size_t size = dfa.size();
-    for (size_t i = 0; i < size; i++)
+    ofstream dotFile("output.dot");
+
+    if (!dotFile.is_open()) {
+        cerr << "Error: Unable to open file for writing: output.dot" << endl;
+        return;
+    }
+
+    dotFile << "digraph DFA {\n";
+    dotFile << "    rankdir=LR;\n";
+    dotFile << "    node [shape = circle];\n";
+
+    for (const auto& [stateID, state] : dfa)
     {
-        const DFAState& current = dfa.at(i);
-        if (current.states == state)
+        for (const char& symbol : alphabet)
         {
-            return i;
+            auto it = state.moves.find(symbol);
+            if (it != state.moves.end() && it->second != -1)
+            {
+                dotFile << "    " << stateID << " -> " << it->second << " [label=\"" << symbol << "\"];\n";
+            }
         }
     }
 
-    return nullopt;
-}
+    dotFile << "}";
 
-vector<int> EClosure(const vector<int>& state, const NFA& nfa)
-{
-    vector<int> eClosure;
-    stack<int> myStack;
+    dotFile.close();
+    string command = "dot -Tpng output.dot -o output.png";
+    system(command.c_str());
 
-    for (const auto& el : state)
-    {
-        myStack.push(el);
-    }
+    cout << "Result in: output.png" << endl;
+}
 
-    for (const auto& el : state)
+void PrintDFA(const DFA& dfa, const vector<char>& alphabet)
+{
+    cout << "   ";
+    for (auto k = alphabet.begin(); k != alphabet.end() - 1; k++)
     {
-        eClosure.push_back(el);
+        cout << *k << "    ";
     }
+    cout << endl;
 
-    while (!myStack.empty())
+    for (const auto& [stateID, state] : dfa)
     {
-        int current = myStack.top();
-        myStack.pop();
-
-        auto it = nfa.find(current);
-        if (it != nfa.end() && it->second.find('E') != it->second.end())
+        cout << stateID << " ";
+        for (auto k = alphabet.begin(); k != alphabet.end() - 1; k++)
         {
-            vector<int> eMoves = it->second.at('E');
-            for (const auto& el : eMoves)
+            cout << OPEN_SYMBOL;
+            if (state.moves.at(*k) != -1)
             {
-                if (!HasVector(eClosure, el))
-                {
-                    eClosure.push_back(el);
-                    myStack.push(el);
-                }
+                cout << state.moves.at(*k);
             }
+            cout << CLOSE_SYMBOL << "   ";
         }
+        cout << endl;
     }
+}
 
-    sort(eClosure.begin(), eClosure.end());
+struct Args
+{
+    string fileName;
+    optional<string> regex;
+    // Режим --union: автоматы из файлов объединяются в один DFA
+    vector<string> unionFileNames;
+    optional<string> matchInput;
+    Automata::DeterminizeOptions options;
+    bool hasBudget = false;
+    bool tableStats = false;
+    // Перенумерация состояний для сканирования и файл с обучающим входом
+    optional<Automata::StateOrder> stateOrder;
+    string traceFileName;
+    bool hugePages = false;
+    // Потоков для сканирования, 0 - по числу ядер
+    size_t threadCount = 1;
+    // Сразу минимальный DFA выбранным способом
+    optional<Automata::MinimizeStrategy> strategy;
+};
 
-    return eClosure;
-}
+const string USAGE = "Usage: <program.exe> <file_name.txt> [--max-states <count> [--stop-on-estimate]] [--max-bytes <count>] [--match <input>]"
+    " [--strategy <subset|brzozowski>] [--table-stats] [--reorder <bfs|cm|profile> [--trace <file>] [--huge-pages] [--threads <count>]]"
+    " | --regex <pattern> [--table-stats] [--reorder ...] | --union <file_name.txt>... [--match <input>]";
 
-vector<int> GetReachableStates(const vector<int>& state, char move, const NFA& nfa)
+Args ParseArgs(int argc, char* argv[])
 {
-    vector<int> result;
-    for (const auto& el : state)
+    if (argc < 2)
     {
-        const auto& transitions = nfa.at(el);
-        auto it = transitions.find(move);
-        if (it != transitions.end())
+        throw invalid_argument("No file given.\n" + USAGE);
+    }
+    Args args;
+    if (string(argv[1]) == "--regex")
+    {
+        if (argc < 3)
         {
-            for (const auto& reachable : it->second)
-            {
-                if (!HasVector(result, reachable))
-                {
-                    result.push_back(reachable);
-                }
-            }
+            throw invalid_argument("No pattern given.\nUsage: <program.exe> --regex <pattern>");
         }
+        args.regex = argv[2];
     }
-
-    return result;
-}
-
-vector<int> GetDFAFinalStates(const DFA& dfa, const vector<int>& finalStates)
-{
-    vector<int> finals;
-    for (const auto& [stateID, dfaState] : dfa)
+    else if (string(argv[1]) == "--union")
     {
-        for (auto const& el : finalStates)
+        for (int i = 2; i < argc && string(argv[i]).rfind("--", 0) != 0; i++)
         {
-            if (HasVector(dfaState.states, el))
-            {
-                finals.push_back(stateID);
-            }
+            args.unionFileNames.push_back(argv[i]);
+        }
+        if (args.unionFileNames.empty())
+        {
+            throw invalid_argument("No file given.\n" + USAGE);
         }
     }
-
-    return finals;
+    else
+    {
+        args.fileName = argv[1];
+    }
+    int first = args.regex ? 3 : args.unionFileNames.empty() ? 2 : 2 + int(args.unionFileNames.size());
+    for (int i = first; i < argc; i++)
+    {
+        string option = argv[i];
+        if (option == "--table-stats" || option == "--huge-pages")
+        {
+            (option == "--table-stats" ? args.tableStats : args.hugePages) = true;
+            continue;
+        }
+        if (option == "--stop-on-estimate")
+        {
+            args.options.stopOnEstimate = true;
+            continue;
+        }
+        if (i + 1 == argc)
+        {
+            throw invalid_argument(USAGE);
+        }
+        if (option == "--match")
+        {
+            args.matchInput = argv[++i];
+        }
+        else if (option == "--reorder")
+        {
+            args.stateOrder = Automata::ParseStateOrder(argv[++i]);
+        }
+        else if (option == "--trace")
+        {
+            args.traceFileName = argv[++i];
+        }
+        else if (option == "--strategy")
+        {
+            args.strategy = Automata::ParseMinimizeStrategy(argv[++i]);
+        }
+        else if (option == "--threads")
+        {
+            args.threadCount = stoull(argv[++i]);
+        }
+        else if (option == "--max-states")
+        {
+            args.options.maxStates = stoull(argv[++i]);
+            args.hasBudget = true;
+        }
+        else if (option == "--max-bytes")
+        {
+            args.options.maxBytes = stoull(argv[++i]);
+            args.hasBudget = true;
+        }
+        else
+        {
+            throw invalid_argument(USAGE);
+        }
+    }
+    return args;
 }
 
-void SubsetConstruction(int initialState, const vector<int>& finalStates, const NFA& nfa, DFA& dfa, const vector<char>& alphabet)
+// Столбец 'E' - эпсилон-переходы. Состояния, недостижимые из начального или не ведущие
+// в заключительные, отбрасываются.
+// originalIds - номера состояний из файла по номерам состояний движка
+Automata::Nfa ToEngineNfa(const NfaTable& nfa, vector<int>& originalIds)
 {
-    int currentDFAStateNumber = 0;
-    vector<int> initialStateVector;
-    initialStateVector.push_back(initialState);
-
-    vector<int> eClosure = EClosure(initialStateVector, nfa);
-
-    DFAState initState;
-    initState.marked = false;
-    initState.states = eClosure;
-
-    dfa[currentDFAStateNumber] = initState;
-    currentDFAStateNumber++;
-
-    auto unmarkedState = FindUnmarked(dfa);
-    while (unmarkedState != nullopt)
+    const size_t columnCount = nfa.alphabet.size();
+    const int rowCount = nfa.totalStates;
+    auto isRow = [rowCount](int state) {
+        return state >= 1 && state <= rowCount;
+    };
+
+    vector<int> states(rowCount);
+    for (int state = 1; state <= rowCount; state++)
     {
-        dfa[*unmarkedState].marked = true;
+        states[state - 1] = state;
+    }
+    UsefulStates<int> useful(states, nfa.initState, nfa.finalStates, [&](int state, const auto& visit) {
+        const size_t row = size_t(state - 1) * columnCount;
+        for (uint32_t i = nfa.offsets[row]; i < nfa.offsets[row + columnCount]; i++)
+        {
+            visit(nfa.targets[i]);
+        }
+    });
 
-        for (auto w = alphabet.begin(); w != alphabet.end() - 1; w++)
+    Automata::Nfa engineNfa;
+    vector<int> index(size_t(rowCount) + 1, Automata::NO_STATE);
+    originalIds.clear();
+    for (int state = 1; state <= rowCount; state++)
+    {
+        if (!useful.IsRemoved(state))
         {
-            vector<int> move = GetReachableStates(dfa[*unmarkedState].states, *w, nfa);
-            vector<int> alphaMove = EClosure(move, nfa);
+            index[state] = engineNfa.AddState(HasVector(nfa.finalStates, state));
+            originalIds.push_back(state);
+        }
+    }
+    int start = isRow(nfa.initState) ? index[nfa.initState] : engineNfa.AddState(HasVector(nfa.finalStates, nfa.initState));
+    if (!isRow(nfa.initState))
+    {
+        originalIds.push_back(nfa.initState);
+    }
+    engineNfa.SetStart(start);
 
-            auto foundState = FindState(alphaMove, dfa);
-            if (foundState != nullopt)
-            {
-                dfa[*unmarkedState].moves[*w] = *foundState;
-            }
-            else
+    // Переходы добавляются по возрастанию символа
+    vector<size_t> columns(columnCount);
+    for (size_t column = 0; column < columnCount; column++)
+    {
+        columns[column] = column;
+    }
+    stable_sort(columns.begin(), columns.end(), [&nfa](size_t a, size_t b) {
+        return nfa.alphabet[a] < nfa.alphabet[b];
+    });
+    for (int state = 1; state <= rowCount; state++)
+    {
+        if (index[state] == Automata::NO_STATE)
+        {
+            continue;
+        }
+        for (size_t column : columns)
+        {
+            const size_t cell = size_t(state - 1) * columnCount + column;
+            for (uint32_t i = nfa.offsets[cell]; i < nfa.offsets[cell + 1]; i++)
             {
-                if (!alphaMove.empty())
+                int target = nfa.targets[i];
+                if (!isRow(target) || index[target] == Automata::NO_STATE)
+                {
+                    continue;
+                }
+                if (nfa.alphabet[column] == 'E')
                 {
-                    DFAState newState;
-                    newState.marked = false;
-                    newState.states = alphaMove;
-                    dfa[currentDFAStateNumber] = newState;
-                    dfa[*unmarkedState].moves[*w] = currentDFAStateNumber;
-                    currentDFAStateNumber++;
+                    engineNfa.AddEpsilon(index[state], index[target]);
                 }
                 else
                 {
-                    dfa[*unmarkedState].moves[*w] = -1;
+                    engineNfa.AddTransition(index[state], nfa.alphabet[column], index[target]);
                 }
             }
         }
-
-        unmarkedState = FindUnmarked(dfa);
     }
+
+    return engineNfa;
 }
 
-void MoveToData(istringstream& iss)
+// Состояния DFA нумеруются в порядке обхода в ширину, символы перебираются в порядке алфавита файла.
+// Если бюджет превышен, dfa не заполняется.
+Automata::DeterminizeReport SubsetConstruction(const NfaTable& nfa, DFA& dfa, Automata::DeterminizeOptions options,
+    Automata::Dfa& engineDfa)
 {
-    while (iss.peek() != OPEN_SYMBOL)
+    vector<int> originalIds;
+    Automata::Nfa engineNfa = ToEngineNfa(nfa, originalIds);
+    options.alphabet.assign(nfa.alphabet.begin(), nfa.alphabet.end() - 1);
+
+    Automata::SubsetEngine engine;
+    Automata::DeterminizeReport report;
+    engineDfa = engine.Determinize(engineNfa, options, report);
+    if (!report.complete)
     {
-        iss.ignore();
+        return report;
     }
 
-    iss.ignore();
-}
-
-void ReadFile(const string& fileName, int& initState, vector<int>& finalStates, int& totalStates, vector<char>& alphabet, NFA& stateTable)
-{
-    string line;
-    ifstream input(fileName);
-
-    if (!input.is_open())
+    for (int state = 0; state < int(engineDfa.GetStateCount()); state++)
     {
-        throw invalid_argument("Ошибка при открытии файла");
+        DFAState& dfaState = dfa[state];
+        dfaState.marked = true;
+        for (int nfaState : engine.GetSubset(state))
+        {
+            dfaState.states.push_back(originalIds[nfaState]);
+        }
+        sort(dfaState.states.begin(), dfaState.states.end());
+        for (size_t symbol = 0; symbol < options.alphabet.size(); symbol++)
+        {
+            dfaState.moves[options.alphabet[symbol]] = engineDfa.GetNextState(state, symbol);
+        }
     }
 
-    std::getline(input, line);
-    istringstream iss(line);
-
-    MoveToData(iss);
-    iss >> initState;
-
-    std::getline(input, line);
-    iss.str(line);
+    return report;
+}
 
-    MoveToData(iss);
-    int finalState;
-    iss >> finalState;
-    finalStates.push_back(finalState);
+// Перевод в представление этой программы: последний символ алфавита - эпсилон, он не печатается
+DFA FromEngineDfa(const Automata::Dfa& engineDfa, vector<char>& alphabet, vector<int>& finalStates)
+{
+    alphabet = engineDfa.GetSymbols();
+    alphabet.push_back('E');
 
-    while (iss.peek() != CLOSE_SYMBOL)
+    DFA dfa;
+    for (int state = 0; state < int(engineDfa.GetStateCount()); state++)
     {
-        if (iss.peek() == ',')
+        DFAState& dfaState = dfa[state];
+        dfaState.marked = true;
+        for (size_t symbol = 0; symbol < engineDfa.GetSymbols().size(); symbol++)
+        {
+            dfaState.moves[alphabet[symbol]] = engineDfa.GetNextState(state, symbol);
+        }
+        if (engineDfa.IsAccepting(state))
         {
-            iss.ignore();
+            finalStates.push_back(state);
         }
-        iss >> finalState;
-        finalStates.push_back(finalState);
     }
+    return dfa;
+}
 
-    std::getline(input, line);
-    iss.str(line);
+Automata::Dfa DeterminizeWithReport(const string& name, const Automata::Nfa& nfa)
+{
+    size_t edgeCount = 0, epsilonCount = 0;
+    for (int state = 0; state < int(nfa.GetStateCount()); state++)
+    {
+        edgeCount += nfa.GetEdges(state).size();
+        epsilonCount += nfa.GetEpsilonEdges(state).size();
+    }
 
-    MoveToData(iss);
-    iss >> totalStates;
+    auto start = chrono::steady_clock::now();
+    Automata::Dfa dfa = Automata::Determinize(nfa);
+    auto elapsed = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
 
-    std::getline(input, line);
-    char symbol;
-    istringstream alphabetStream(line);
+    cout << name << ": NFA " << nfa.GetStateCount() << " states, " << edgeCount << " edges, "
+        << epsilonCount << " epsilon edges; DFA " << dfa.GetStateCount() << " states in " << elapsed << " ms" << endl;
+    return dfa;
+}
 
-    while (alphabetStream >> symbol)
-    {
-        alphabet.push_back(symbol);
-    }
+void PrintReport(const Automata::DeterminizeReport& report)
+{
+    cout << "DFA states expanded: " << report.expandedStates << (report.complete ? "" : " (budget exceeded)")
+        << ", estimated total: " << report.estimatedStates << ", peak bytes: " << report.peakBytes << endl;
+}
 
-    std::getline(input, line);
+void PrintReport(const Automata::MinimizeReport& report)
+{
+    cout << "Peak DFA states: " << report.peakStates << (report.complete ? "" : " (budget exceeded)")
+        << ", minimal DFA states: " << report.resultStates << ", peak bytes: " << report.peakBytes
+        << ", time: " << report.milliseconds << " ms" << endl;
+}
 
-    for (int i = 1; i <= totalStates; i++)
+// Случайное блуждание по существующим переходам, из тупика - в начальное состояние.
+// Пусто, если из начального состояния переходов нет.
+string GenerateRandomWalk(const Automata::Dfa& dfa, size_t length)
+{
+    mt19937 random(42);
+    string input;
+    input.reserve(length);
+    vector<char> available;
+    int state = 0;
+    while (input.size() < length)
     {
-        istringstream stateIss(line);
-        map<char, vector<int>> stateMoves;
-
-        for (int j = 0; j < alphabet.size(); j++)
+        available.clear();
+        for (char symbol : dfa.GetSymbols())
         {
-            int state;
-            string movesStr;
-            vector<int> states;
-
-            if (j == 0)
+            if (dfa.GetNextStateBySymbol(state, symbol) != Automata::NO_STATE)
             {
-                stateIss.ignore();
-                stateIss.ignore();
+                available.push_back(symbol);
             }
-            else
-            {
-                stateIss.ignore();
-            }
-
-            stateIss >> movesStr;
-            movesStr = movesStr.substr(1, movesStr.size() - 2);
-
-            if (movesStr != "")
+        }
+        if (available.empty())
+        {
+            if (state == 0)
             {
-                istringstream moveIss(movesStr);
-
-                while (moveIss >> state)
-                {
-                    states.push_back(state);
-                    if (moveIss.peek() == ',')
-                    {
-                        moveIss.ignore();
-                    }
-                }
+                return {};
             }
-
-            sort(states.begin(), states.end());
-            stateMoves[alphabet[j]] = states;
+            state = 0;
+            continue;
         }
+        char symbol = available[random() % available.size()];
+        input += symbol;
+        state = dfa.GetNextStateBySymbol(state, symbol);
+    }
+    return input;
+}
 
-        stateTable[i] = stateMoves;
-        std::getline(input, line);
+// Одна и та же последовательность переходов по каждому представлению таблицы
+template <class NextState>
+void MeasureLookups(const string& name, size_t bytes, const string& input, NextState&& nextState)
+{
+    auto start = chrono::steady_clock::now();
+    int state = 0;
+    size_t checksum = 0;
+    for (char symbol : input)
+    {
+        state = nextState(state, symbol);
+        if (state == Automata::NO_STATE)
+        {
+            state = 0;
+        }
+        checksum += state;
     }
+    auto elapsed = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+    cout << "  " << name << ": " << bytes << " bytes, " << elapsed / input.size() << " ns per lookup (checksum "
+        << checksum << ")" << endl;
 }
 
-void VisualizeDFA(const DFA& dfa, const vector<char>& alphabet)
+// Память и скорость переходов: плотная таблица по символам и по классам, таблица со смещением строк и map
+void ReportTableFormats(const Automata::Dfa& engineDfa, const DFA& dfa)
 {
-    ofstream dotFile("output.dot");
+    const size_t LOOKUP_COUNT = 10000000;
+    // Узел красно-чёрного дерева: три указателя и цвет перед значением
+    const size_t MAP_NODE_OVERHEAD = 4 * sizeof(void*);
 
-    if (!dotFile.is_open()) {
-        cerr << "Error: Unable to open file for writing: output.dot" << endl;
+    if (engineDfa.GetStateCount() == 0)
+    {
         return;
     }
 
-    dotFile << "digraph DFA {\n";
-    dotFile << "    rankdir=LR;\n";
-    dotFile << "    node [shape = circle];\n";
-
-    for (const auto& [stateID, state] : dfa)
+    const auto& symbols = engineDfa.GetSymbols();
+    string input = GenerateRandomWalk(engineDfa, LOOKUP_COUNT);
+    if (input.empty())
     {
-        for (const char& symbol : alphabet)
-        {
-            auto it = state.moves.find(symbol);
-            if (it != state.moves.end() && it->second != -1)
-            {
-                dotFile << "    " << stateID << " -> " << it->second << " [label=\"" << symbol << "\"];\n";
-            }
-        }
+        return;
     }
 
-    dotFile << "}";
+    const size_t stateCount = engineDfa.GetStateCount();
+    Automata::Dfa classDfa = engineDfa;
+    classDfa.CompressSymbols();
+    Automata::CombDfa combDfa(classDfa);
 
-    dotFile.close();
-    string command = "dot -Tpng output.dot -o output.png";
-    system(command.c_str());
+    size_t mapBytes = 0;
+    for (const auto& [id, dfaState] : dfa)
+    {
+        mapBytes += sizeof(pair<const int, DFAState>) + MAP_NODE_OVERHEAD + dfaState.states.capacity() * sizeof(int)
+            + dfaState.moves.size() * (sizeof(pair<const char, int>) + MAP_NODE_OVERHEAD);
+    }
 
-    cout << "Result in: output.png" << endl;
+    cout << "Table formats for " << stateCount << " states, " << symbols.size() << " symbols, "
+        << classDfa.GetClassCount() << " classes, " << combDfa.GetEntryCount() << " comb entries:" << endl;
+    MeasureLookups("dense", stateCount * (symbols.size() * sizeof(int) + 1), input, [&](int state, char symbol) {
+        return engineDfa.GetNextStateBySymbol(state, symbol);
+    });
+    MeasureLookups("dense by class", stateCount * (classDfa.GetClassCount() * sizeof(int) + 1), input, [&](int state, char symbol) {
+        return classDfa.GetNextStateBySymbol(state, symbol);
+    });
+    MeasureLookups("comb", combDfa.GetMemoryUsage(), input, [&](int state, char symbol) {
+        return combDfa.GetNextState(state, symbol);
+    });
+    MeasureLookups("map", mapBytes, input, [&](int state, char symbol) {
+        const auto& moves = dfa.at(state).moves;
+        auto it = moves.find(symbol);
+        return it == moves.end() ? Automata::NO_STATE : it->second;
+    });
 }
 
-void PrintDFA(const DFA& dfa, const vector<char>& alphabet)
+// Время сканирования в исходной нумерации и после перенумерации; профиль и вход - из --trace
+// или случайное блуждание
+void ReportReordering(const Automata::Dfa& engineDfa, const Args& args)
 {
-    cout << "   ";
-    for (auto k = alphabet.begin(); k != alphabet.end() - 1; k++)
+    const size_t WALK_LENGTH = 10000000;
+    if (engineDfa.GetStateCount() == 0)
     {
-        cout << *k << "    ";
+        return;
     }
-    cout << endl;
 
-    for (const auto& [stateID, state] : dfa)
+    string trace;
+    if (!args.traceFileName.empty())
     {
-        cout << stateID << " ";
-        for (auto k = alphabet.begin(); k != alphabet.end() - 1; k++)
+        ifstream input(args.traceFileName, ios::binary);
+        if (!input.is_open())
         {
-            cout << OPEN_SYMBOL;
-            if (state.moves.at(*k) != -1)
-            {
-                cout << state.moves.at(*k);
-            }
-            cout << CLOSE_SYMBOL << "   ";
+            throw runtime_error("Cannot open file: " + args.traceFileName);
         }
-        cout << endl;
+        trace.assign(istreambuf_iterator<char>(input), istreambuf_iterator<char>());
+    }
+    else
+    {
+        trace = GenerateRandomWalk(engineDfa, WALK_LENGTH);
+    }
+
+    Automata::Dfa classDfa = engineDfa;
+    classDfa.CompressSymbols();
+    Automata::Dfa reordered = Automata::Renumber(classDfa, Automata::GetStateOrder(classDfa, *args.stateOrder, trace));
+
+    auto measure = [&](const string& name, const Automata::Dfa& dfa, size_t threadCount) {
+        Automata::PackedDfa packed(dfa, args.hugePages);
+        auto start = chrono::steady_clock::now();
+        size_t matches = packed.CountMatches(trace, threadCount);
+        auto elapsed = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        cout << "  " << name << ": " << elapsed << " ms, " << matches << " matches, " << packed.GetMemoryUsage()
+            << " bytes" << (packed.IsHugePages() ? " in huge pages" : "") << endl;
+    };
+    cout << "Scan of " << trace.size() << " bytes:" << endl;
+    measure("discovery order", classDfa, 1);
+    measure("reordered", reordered, 1);
+    if (args.threadCount != 1)
+    {
+        measure("reordered, parallel chunks", reordered, args.threadCount);
     }
 }
 
-string ParseArgs(int argc, char* argv[])
+void PrintResult(const Automata::Dfa& engineDfa, const DFA& dfa, const vector<int>& finalStates,
+    const vector<char>& alphabet, const Args& args)
 {
-    if (argc < 2)
+    cout << "Initial state: [0]" << endl;
+    cout << "Final states: ";
+    PrintVector(finalStates);
+    cout << endl;
+    PrintDFA(dfa, alphabet);
+    VisualizeDFA(dfa, alphabet);
+    if (args.tableStats)
+    {
+        ReportTableFormats(engineDfa, dfa);
+    }
+    if (args.stateOrder)
     {
-        throw invalid_argument("No file given.\nUsage: <program.exe> <file_name.txt>");
+        ReportReordering(engineDfa, args);
     }
-    return argv[1];
 }
 
-int main(int argc, char* argv[])
+// Строит DFA по регулярному выражению через автомат Томпсона и автомат позиций и сравнивает их
+void RunRegex(const Args& args)
 {
-    try
+    Automata::Regex regex(*args.regex);
+    cout << "Positions: " << regex.GetPositionCount() << endl;
+    DeterminizeWithReport("Thompson", regex.BuildThompson());
+    Automata::Dfa engineDfa = DeterminizeWithReport("Glushkov", regex.BuildGlushkov());
+
+    vector<char> alphabet;
+    vector<int> finalStates;
+    DFA dfa = FromEngineDfa(engineDfa, alphabet, finalStates);
+    PrintResult(engineDfa, dfa, finalStates, alphabet, args);
+}
+
+// Минимальный DFA выбранным способом; время и наибольший промежуточный DFA - для выбора способа
+void RunMinimal(const NfaTable& nfa, const Args& args)
+{
+    vector<int> originalIds;
+    Automata::Nfa engineNfa = ToEngineNfa(nfa, originalIds);
+    Automata::DeterminizeOptions options = args.options;
+    options.alphabet.assign(nfa.alphabet.begin(), nfa.alphabet.end() - 1);
+
+    Automata::MinimizeReport report;
+    Automata::Dfa engineDfa = Automata::DeterminizeMinimal(engineNfa, *args.strategy, options, report);
+    PrintReport(report);
+    if (!report.complete)
     {
-        string fileName = ParseArgs(argc, argv);
+        throw runtime_error("Determinization budget exceeded");
+    }
 
-        int initState;
-        vector<int> finalStates;
-        int totalStates;
-        vector<char> alphabet;
-        NFA stateTable;
-        DFA dfa;
+    vector<char> alphabet;
+    vector<int> finalStates;
+    DFA dfa = FromEngineDfa(engineDfa, alphabet, finalStates);
+    PrintResult(engineDfa, dfa, finalStates, alphabet, args);
+}
 
-        ReadFile(fileName, initState, finalStates, totalStates, alphabet, stateTable);
-        SubsetConstruction(initState, finalStates, stateTable, dfa, alphabet);
+// Один DFA для всех автоматов, каждое состояние помнит, какие из них допускают
+void RunUnion(const Args& args)
+{
+    vector<Automata::Nfa> patterns;
+    for (const auto& fileName : args.unionFileNames)
+    {
+        vector<int> originalIds;
+        patterns.push_back(ToEngineNfa(ReadNfaTable(fileName), originalIds));
+    }
 
-        cout << "Initial state: [0]" << endl;
-        cout << "Final states: ";
-        PrintVector(GetDFAFinalStates(dfa, finalStates));
-        cout << endl;
-        PrintDFA(dfa, alphabet);
-        VisualizeDFA(dfa, alphabet);
+    Automata::MultiPatternDfa dfa(patterns, args.options);
+    cout << "Patterns: " << dfa.GetPatternCount() << ", DFA states: " << dfa.GetDfa().GetStateCount()
+        << ", distinct accept sets: " << dfa.GetPatternSetCount() << ", symbol classes: " << dfa.GetDfa().GetClassCount()
+        << " of " << dfa.GetDfa().GetSymbols().size() << endl;
+
+    if (args.matchInput)
+    {
+        auto matched = dfa.Match(*args.matchInput);
+        if (matched.empty())
+        {
+            cout << "Rejected" << endl;
+        }
+        for (int pattern : matched)
+        {
+            cout << "Matched: " << args.unionFileNames[pattern] << endl;
+        }
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    try
+    {
+        Args args = ParseArgs(argc, argv);
+        if (args.regex)
+        {
+            RunRegex(args);
+            return EXIT_SUCCESS;
+        }
+        if (!args.unionFileNames.empty())
+        {
+            RunUnion(args);
+            return EXIT_SUCCESS;
+        }
+        NfaTable nfa = ReadNfaTable(args.fileName);
+        DFA dfa;
+        if (args.matchInput)
+        {
+            vector<int> originalIds;
+            Automata::Nfa engineNfa = ToEngineNfa(nfa, originalIds);
+            bool accepted;
+            if (args.hasBudget)
+            {
+                // DFA в пределах бюджета, дальше моделирование NFA
+                Automata::HybridExecutor executor(engineNfa, args.options);
+                PrintReport(executor.GetReport());
+                accepted = executor.Accepts(*args.matchInput);
+            }
+            else
+            {
+                // Проверка строки моделированием NFA, без построения DFA
+                accepted = Automata::BitParallelNfa(engineNfa).Accepts(*args.matchInput);
+            }
+            cout << (accepted ? "Accepted" : "Rejected") << endl;
+            return EXIT_SUCCESS;
+        }
+        if (args.strategy)
+        {
+            RunMinimal(nfa, args);
+            return EXIT_SUCCESS;
+        }
+        Automata::Dfa engineDfa;
+        auto report = SubsetConstruction(nfa, dfa, args.options, engineDfa);
+        if (!report.complete)
+        {
+            PrintReport(report);
+            throw runtime_error("Determinization budget exceeded");
+        }
+        PrintResult(engineDfa, dfa, GetDFAFinalStates(dfa, nfa.finalStates), nfa.alphabet, args);
     }
     catch (const exception& e)
     {
@@ -1,8 +1,8 @@
 #include "DFA.h"
 #include <fstream>
-#include <stack>
 #include <algorithm>
 #include <set>
+#include "../../common/Trim.h"
 
 #include <iostream>
 
@@ -15,6 +15,24 @@ namespace
     const char EPSILLON = 'E';
     const char NEW_STATE = 'Z';
 
+    //  DFA     'A'     
+    char GetStateId(int state)
+    {
+        return char('A' + state);
+    }
+
+    //  0xFF   char(-1) - " ",    'A'  0xFE
+    const size_t MAX_STATE_COUNT = 0xFF - 'A';
+
+    void CheckStateCount(size_t stateCount)
+    {
+        if (stateCount > MAX_STATE_COUNT)
+        {
+            throw length_error("DFA has " + to_string(stateCount) + " states, at most " + to_string(MAX_STATE_COUNT)
+                + " can be named");
+        }
+    }
+
     bool HasVector(const vector<char>& vector, char symb)
     {
         for (const auto& el : vector)
@@ -39,68 +57,6 @@ namespace
         output << "]";
     }
 
-    vector<char> EClosure(const vector<char>& state, const DFA::NFAData& nfa)
-    {
-        vector<char> eClosure;
-        stack<char> myStack;
-
-        for (const auto& el : state)
-        {
-            myStack.push(el);
-        }
-
-        for (const auto& el : state)
-        {
-            eClosure.push_back(el);
-        }
-
-        while (!myStack.empty())
-        {
-            char current = myStack.top();
-            myStack.pop();
-
-            auto it = nfa.find(current);
-            if (it != nfa.end() && it->second.find('E') != it->second.end())
-            {
-                vector<char> eMoves = it->second.at('E');
-                for (const auto& el : eMoves)
-                {
-                    if (!HasVector(eClosure, el))
-                    {
-                        eClosure.push_back(el);
-                        myStack.push(el);
-                    }
-                }
-            }
-        }
-
-        sort(eClosure.begin(), eClosure.end());
-
-        return eClosure;
-    }
-    
-    vector<char> GetReachableStates(const vector<char>& state, char move, const DFA::NFAData& nfa)
-    {
-        vector<char> result;
-        for (const auto& el : state)
-        {
-            const auto& transitions = nfa.at(el);
-            auto it = transitions.find(move);
-            if (it != transitions.end())
-            {
-                for (const auto& reachable : it->second)
-                {
-                    if (!HasVector(result, reachable))
-                    {
-                        result.push_back(reachable);
-                    }
-                }
-            }
-        }
-
-        return result;
-    }
-
     struct NFAInfo
     {
         char initState;
@@ -244,26 +200,178 @@ namespace
         return nfaInfo;
     }
 
+    //  ,        
+    void TrimNFA(NFAInfo& nfaInfo)
+    {
+        vector<char> states;
+        for (const auto& [state, transitions] : nfaInfo.transitions)
+        {
+            states.push_back(state);
+        }
+
+        UsefulStates<char> useful(states, nfaInfo.initState, nfaInfo.finalStates, [&nfaInfo](char state, const auto& visit) {
+            for (const auto& [symbol, targets] : nfaInfo.transitions.at(state))
+            {
+                for (char target : targets)
+                {
+                    visit(target);
+                }
+            }
+        });
+        auto isRemoved = [&useful](char state) {
+            return useful.IsRemoved(state);
+        };
+
+        for (char state : states)
+        {
+            if (isRemoved(state))
+            {
+                nfaInfo.transitions.erase(state);
+                continue;
+            }
+            for (auto& [symbol, targets] : nfaInfo.transitions[state])
+            {
+                targets.erase(remove_if(targets.begin(), targets.end(), isRemoved), targets.end());
+            }
+        }
+    }
+
     NFAInfo ConvertGrammarToNFA(const Grammar& grammar)
     {
         return grammar.GetSide() == Grammar::Side::Left
             ? ConvertLeftGrammarToNFA(grammar)
             : ConvertRightGrammarToNFA(grammar);
     }
+    // originalIds -     
+    Automata::Nfa ToEngineNfa(const NFAInfo& data, vector<char>& originalIds)
+    {
+        Automata::Nfa nfa;
+        map<char, int> index;
+        originalIds.clear();
+        for (const auto& [state, transitions] : data.transitions)
+        {
+            bool accepting = find(data.finalStates.begin(), data.finalStates.end(), state) != data.finalStates.end();
+            index[state] = nfa.AddState(accepting);
+            originalIds.push_back(state);
+        }
+        if (!index.count(data.initState))
+        {
+            index[data.initState] = nfa.AddState();
+            originalIds.push_back(data.initState);
+        }
+        nfa.SetStart(index[data.initState]);
+
+        for (const auto& [state, transitions] : data.transitions)
+        {
+            for (const auto& [symbol, targets] : transitions)
+            {
+                for (char target : targets)
+                {
+                    auto it = index.find(target);
+                    if (it != index.end())
+                    {
+                        nfa.AddTransition(index[state], symbol, it->second);
+                    }
+                }
+            }
+        }
+
+        return nfa;
+    }
 }
 
-DFA::DFA(const Grammar& grammar)
+Automata::Nfa BuildGrammarNfa(const Grammar& grammar)
 {
     auto data = ConvertGrammarToNFA(grammar);
+    TrimNFA(data);
+    vector<char> originalIds;
+    return ToEngineNfa(data, originalIds);
+}
+
+DFA::DFA(const Grammar& grammar, const Automata::DeterminizeOptions& options)
+{
+    auto data = ConvertGrammarToNFA(grammar);
+    TrimNFA(data);
     m_alphabet = data.alphabet;
 
-    SubsetConstruction(data.initState, data.finalStates, data.transitions);
+    vector<char> originalIds;
+    Automata::Nfa nfa = ToEngineNfa(data, originalIds);
+    auto report = SubsetConstruction(nfa, originalIds, options);
+    if (!report.complete)
+    {
+        throw runtime_error("Determinization budget exceeded: " + to_string(report.expandedStates) + " states expanded, "
+            + to_string(size_t(report.estimatedStates)) + " estimated, " + to_string(report.peakBytes) + " bytes");
+    }
     m_finalStates = GetDFAFinalStates(data.finalStates);
 }
 
+DFA::DFA(const Grammar& grammar, Automata::MinimizeStrategy strategy, const Automata::DeterminizeOptions& options,
+    Automata::MinimizeReport& report)
+{
+    auto data = ConvertGrammarToNFA(grammar);
+    TrimNFA(data);
+    m_alphabet = data.alphabet;
+
+    vector<char> originalIds;
+    Automata::Nfa nfa = ToEngineNfa(data, originalIds);
+    Automata::DeterminizeOptions minimizeOptions = options;
+    minimizeOptions.alphabet = m_alphabet;
+    m_alphabet.push_back('E');
+
+    Automata::Dfa dfa = Automata::DeterminizeMinimal(nfa, strategy, minimizeOptions, report);
+    if (!report.complete)
+    {
+        throw runtime_error("Determinization budget exceeded: " + to_string(report.peakStates) + " states, "
+            + to_string(report.peakBytes) + " bytes");
+    }
+    Assign(dfa, vector<vector<char>>(dfa.GetStateCount()));
+}
+
 void DFA::Minimize()
 {
+    map<char, int> index;
+    Automata::Dfa dfa = ToEngineDfa(index);
 
+    vector<int> stateMap;
+    Automata::Dfa minimized = Automata::Minimize(dfa, stateMap);
+    vector<vector<char>> subsets(minimized.GetStateCount());
+    for (const auto& [stateID, state] : m_data)
+    {
+        int newState = stateMap[index[stateID]];
+        if (newState != Automata::NO_STATE)
+        {
+            subsets[newState].insert(subsets[newState].end(), state.states.begin(), state.states.end());
+        }
+    }
+    Assign(minimized, subsets);
+}
+
+//   -   m_data
+Automata::Dfa DFA::ToEngineDfa(map<char, int>& index) const
+{
+    index.clear();
+    for (const auto& [stateID, state] : m_data)
+    {
+        index[stateID] = int(index.size());
+    }
+
+    Automata::Dfa dfa(vector<char>(m_alphabet.begin(), m_alphabet.end() - 1));
+    for (const auto& [stateID, state] : m_data)
+    {
+        dfa.AddState(find(m_finalStates.begin(), m_finalStates.end(), stateID) != m_finalStates.end());
+    }
+    for (const auto& [stateID, state] : m_data)
+    {
+        for (size_t symbol = 0; symbol < dfa.GetSymbols().size(); symbol++)
+        {
+            auto it = state.moves.find(dfa.GetSymbols()[symbol]);
+            if (it != state.moves.end() && index.count(it->second))
+            {
+                dfa.SetTransition(index[stateID], symbol, index[it->second]);
+            }
+        }
+    }
+    return dfa;
 }
 
 void DFA::Print(ostream& output) const
@@ -337,30 +445,49 @@ void DFA::Display(const string& fileName) const
     cout << "Result in: " << fileName << ".png" << endl;
 }
 
-optional<char> DFA::FindUnmarked() const
+bool DFA::Accepts(const string& input) const
 {
-    for (const auto& [stateID, current] : m_data)
+    char state = m_data.begin()->first;
+    for (char symbol : input)
     {
-        if (!current.marked)
+        const auto& moves = m_data.at(state).moves;
+        auto it = moves.find(symbol);
+        if (it == moves.end() || it->second == -1)
         {
-            return stateID;
+            return false;
         }
+        state = it->second;
     }
 
-    return nullopt;
+    return find(m_finalStates.begin(), m_finalStates.end(), state) != m_finalStates.end();
 }
 
-optional<char> DFA::FindState(const vector<char>& state) const
+CodegenTable DFA::GetCodegenTable(const string& name) const
 {
-    for (const auto& [stateID, current] : m_data)
+    //   -  ,     
+    map<char, int> index;
+    Automata::Dfa dfa = ToEngineDfa(index);
+    dfa.CompressSymbols();
+
+    CodegenTable table;
+    table.name = name;
+    table.stateCount = int(dfa.GetStateCount());
+    table.symbols = dfa.GetSymbols();
+    for (size_t symbol = 0; symbol < table.symbols.size(); symbol++)
     {
-        if (current.states == state)
+        table.symbolClasses.push_back(dfa.GetSymbolClass(symbol));
+    }
+    for (int state = 0; state < table.stateCount; state++)
+    {
+        for (size_t symbol = 0; symbol < table.symbols.size(); symbol++)
         {
-            return stateID;
+            const int next = dfa.GetNextState(state, symbol);
+            table.next.push_back(next == Automata::NO_STATE ? -1 : next);
         }
+        table.accepting.push_back(dfa.IsAccepting(state));
     }
 
-    return nullopt;
+    return table;
 }
 
 vector<char> DFA::GetDFAFinalStates(const vector<char>& finalStates) const
@@ -380,55 +507,60 @@ vector<char> DFA::GetDFAFinalStates(const vector<char>& finalStates) const
     return finals;
 }
 
-void DFA::SubsetConstruction(char initialState, const vector<char>& finalStates, const DFA::NFAData& nfa)
+void DFA::Assign(const Automata::Dfa& dfa, const vector<vector<char>>& subsets)
 {
-    char currentDFAStateNumber = 'A';
-    vector<char> initialStateVector;
-    initialStateVector.push_back(initialState);
-    m_alphabet.push_back('E');
-
-    vector<char> eClosure = EClosure(initialStateVector, nfa);
-
-    DFA::DFAState initState;
-    initState.marked = false;
-    initState.states = eClosure;
+    CheckStateCount(dfa.GetStateCount());
+    m_data.clear();
+    m_finalStates.clear();
+    for (int state = 0; state < int(dfa.GetStateCount()); state++)
+    {
+        DFAState& dfaState = m_data[GetStateId(state)];
+        dfaState.marked = true;
+        dfaState.states = subsets[state];
+        sort(dfaState.states.begin(), dfaState.states.end());
+        dfaState.states.erase(unique(dfaState.states.begin(), dfaState.states.end()), dfaState.states.end());
+        for (size_t symbol = 0; symbol < dfa.GetSymbols().size(); symbol++)
+        {
+            int next = dfa.GetNextState(state, symbol);
+            dfaState.moves[dfa.GetSymbols()[symbol]] = next == Automata::NO_STATE ? char(-1) : GetStateId(next);
+        }
+        if (dfa.IsAccepting(state))
+        {
+            m_finalStates.push_back(GetStateId(state));
+        }
+    }
+}
 
-    m_data[currentDFAStateNumber] = initState;
-    currentDFAStateNumber++;
+Automata::DeterminizeReport DFA::SubsetConstruction(const Automata::Nfa& nfa, const vector<char>& originalIds,
+    Automata::DeterminizeOptions options)
+{
+    options.alphabet = m_alphabet;
+    m_alphabet.push_back('E');
 
-    auto unmarkedState = FindUnmarked();
-    while (unmarkedState != nullopt)
+    Automata::SubsetEngine engine;
+    Automata::DeterminizeReport report;
+    Automata::Dfa dfa = engine.Determinize(nfa, options, report);
+    if (!report.complete)
     {
-        m_data[*unmarkedState].marked = true;
+        return report;
+    }
 
-        for (auto w = m_alphabet.begin(); w != m_alphabet.end() - 1; w++)
+    CheckStateCount(dfa.GetStateCount());
+    for (int state = 0; state < int(dfa.GetStateCount()); state++)
+    {
+        DFAState& dfaState = m_data[GetStateId(state)];
+        dfaState.marked = true;
+        for (int nfaState : engine.GetSubset(state))
         {
-            vector<char> move = GetReachableStates(m_data[*unmarkedState].states, *w, nfa);
-            vector<char> alphaMove = EClosure(move, nfa);
-
-            auto foundState = FindState(alphaMove);
-            if (foundState != nullopt)
-            {
-                m_data[*unmarkedState].moves[*w] = *foundState;
-            }
-            else
-            {
-                if (!alphaMove.empty())
-                {
-                    DFAState newState;
-                    newState.marked = false;
-                    newState.states = alphaMove;
-                    m_data[currentDFAStateNumber] = newState;
-                    m_data[*unmarkedState].moves[*w] = currentDFAStateNumber;
-                    currentDFAStateNumber++;
-                }
-                else
-                {
-                    m_data[*unmarkedState].moves[*w] = -1;
-                }
-            }
+            dfaState.states.push_back(originalIds[nfaState]);
+        }
+        sort(dfaState.states.begin(), dfaState.states.end());
+        for (size_t symbol = 0; symbol < options.alphabet.size(); symbol++)
+        {
+            int next = dfa.GetNextState(state, symbol);
+            dfaState.moves[options.alphabet[symbol]] = next == Automata::NO_STATE ? char(-1) : GetStateId(next);
         }
-
-        unmarkedState = FindUnmarked();
     }
-}
\ No newline at end of file
+
+    return report;
+}
@@ -3,6 +3,10 @@
 #include <map>
 #include <optional>
 #include "Grammar.h"
+#include "../../common/CodeGen.h"
+#include "../NFA_To_DFA/Minimize.h"
+#include "../NFA_To_DFA/Nfa.h"
+#include "../NFA_To_DFA/SubsetEngine.h"
 
 class DFA
 {
@@ -17,18 +21,32 @@ public:
 	using DFAData = std::map<char, DFAState>;
 	using NFAData = std::map<char, std::map<char, std::vector<char>>>;
 
-	DFA(const Grammar& grammar);
+	//    options  runtime_error
+	DFA(const Grammar& grammar, const Automata::DeterminizeOptions& options = {});
+	//   DFA  ,   NFA   .
+	//    options  runtime_error
+	DFA(const Grammar& grammar, Automata::MinimizeStrategy strategy, const Automata::DeterminizeOptions& options,
+		Automata::MinimizeReport& report);
 
+	//      ,   
 	void Minimize();
 	void Print(std::ostream& output) const;
 	void Display(const std::string& fileName) const;
+	bool Accepts(const std::string& input) const;
+	CodegenTable GetCodegenTable(const std::string& name) const;
 
 private:
 	DFAData m_data;
 	std::vector<char> m_finalStates, m_alphabet;
 
-	std::optional<char> FindUnmarked() const;
-	std::optional<char> FindState(const std::vector<char>& state) const;
 	std::vector<char> GetDFAFinalStates(const std::vector<char>& finalStates) const;
-	void SubsetConstruction(char initialState, const std::vector<char>& finalStates, const NFAData& nfa);
-};
\ No newline at end of file
+	// index -     
+	Automata::Dfa ToEngineDfa(std::map<char, int>& index) const;
+	// subsets -   NFA    dfa
+	void Assign(const Automata::Dfa& dfa, const std::vector<std::vector<char>>& subsets);
+	Automata::DeterminizeReport SubsetConstruction(const Automata::Nfa& nfa, const std::vector<char>& originalIds,
+		Automata::DeterminizeOptions options);
+};
+
+// NFA    Automata,   ,   DFA
+Automata::Nfa BuildGrammarNfa(const Grammar& grammar);
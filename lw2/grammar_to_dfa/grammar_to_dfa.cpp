@@ -1,4 +1,9 @@
 ﻿#include "DFA.h"
+#include "../NFA_To_DFA/BitParallelNfa.h"
+#include "../NFA_To_DFA/HybridExecutor.h"
+#include "../NFA_To_DFA/MultiPattern.h"
+#include "../NFA_To_DFA/Product.h"
+#include <fstream>
 
 namespace
 {
@@ -8,31 +13,227 @@ namespace
 	{
 		string fileName;
 		Grammar::Side grammarSide;
+		// Режим --union: грамматики объединяются в один DFA
+		vector<string> unionFileNames;
+		// Режим --product: вторая грамматика с той же стороны и операция над языками
+		std::optional<Automata::ProductOperation> productOperation;
+		string productFileName;
+		std::optional<CodegenStyle> codegenStyle;
+		string codegenFileName;
+		string codegenName = "matcher";
+		std::optional<string> matchInput;
+		Automata::DeterminizeOptions options;
+		bool hasBudget = false;
+		// Сразу минимальный DFA выбранным способом, с отчётом о времени и размере
+		std::optional<Automata::MinimizeStrategy> strategy;
 	};
 
+	const string USAGE = "Usage: program.exe <filename.exe> <gramma_side> [--codegen <direct|table> <output.h> [name]] [--match <input>]"
+		" [--max-states <count> [--stop-on-estimate]] [--max-bytes <count>] [--strategy <subset|brzozowski>] [--product <and|or|minus> <filename.txt>]\n"
+		"       program.exe --union <gramma_side> <filename.txt>... [--match <input>] [--max-states <count>] [--max-bytes <count>]";
+
+	Grammar::Side ParseSide(const string& side)
+	{
+		if (side == "left")
+		{
+			return Grammar::Side::Left;
+		}
+		if (side == "right")
+		{
+			return Grammar::Side::Right;
+		}
+		throw invalid_argument("Side should be left or right");
+	}
+
+	Automata::ProductOperation ParseProductOperation(const string& operation)
+	{
+		if (operation == "and")
+		{
+			return Automata::ProductOperation::Intersection;
+		}
+		if (operation == "or")
+		{
+			return Automata::ProductOperation::Union;
+		}
+		if (operation == "minus")
+		{
+			return Automata::ProductOperation::Difference;
+		}
+		throw invalid_argument("Product operation should be and, or or minus");
+	}
+
 	Args ParseArgs(int argc, char* argv[])
 	{
 		Args args;
 		if (argc < 3)
 		{
-			throw invalid_argument("Usage: program.exe <filename.exe> <gramma_side>");
+			throw invalid_argument(USAGE);
 		}
-		args.fileName = argv[1];
-		string grammarSide = argv[2];
-		if (grammarSide == "left")
+		int i = 3;
+		if (string(argv[1]) == "--union")
 		{
-			args.grammarSide = Grammar::Side::Left;
+			args.grammarSide = ParseSide(argv[2]);
+			for (; i < argc && string(argv[i]).rfind("--", 0) != 0; i++)
+			{
+				args.unionFileNames.push_back(argv[i]);
+			}
+			if (args.unionFileNames.empty())
+			{
+				throw invalid_argument(USAGE);
+			}
 		}
-		else if (grammarSide == "right")
+		else
 		{
-			args.grammarSide = Grammar::Side::Right;
+			args.fileName = argv[1];
+			args.grammarSide = ParseSide(argv[2]);
 		}
-		else
+		for (; i < argc; i++)
 		{
-			throw invalid_argument("Side should be left or right");
+			string option = argv[i];
+			if (option == "--codegen" && i + 2 < argc)
+			{
+				args.codegenStyle = ParseCodegenStyle(argv[++i]);
+				args.codegenFileName = argv[++i];
+				if (i + 1 < argc && string(argv[i + 1]).rfind("--", 0) != 0)
+				{
+					args.codegenName = argv[++i];
+				}
+			}
+			else if (option == "--match" && i + 1 < argc)
+			{
+				args.matchInput = argv[++i];
+			}
+			else if (option == "--product" && i + 2 < argc)
+			{
+				args.productOperation = ParseProductOperation(argv[++i]);
+				args.productFileName = argv[++i];
+			}
+			else if (option == "--max-states" && i + 1 < argc)
+			{
+				args.options.maxStates = stoull(argv[++i]);
+				args.hasBudget = true;
+			}
+			else if (option == "--stop-on-estimate")
+			{
+				args.options.stopOnEstimate = true;
+			}
+			else if (option == "--max-bytes" && i + 1 < argc)
+			{
+				args.options.maxBytes = stoull(argv[++i]);
+				args.hasBudget = true;
+			}
+			else if (option == "--strategy" && i + 1 < argc)
+			{
+				args.strategy = Automata::ParseMinimizeStrategy(argv[++i]);
+			}
+			else
+			{
+				throw invalid_argument(USAGE);
+			}
+		}
+		if (!args.unionFileNames.empty() && (args.codegenStyle || args.productOperation))
+		{
+			throw invalid_argument("--codegen and --product are not supported with --union");
+		}
+		if (args.codegenStyle && (args.productOperation || args.matchInput))
+		{
+			throw invalid_argument("--codegen is not supported with --product or --match");
 		}
 		return args;
 	}
+
+	Automata::Dfa BuildGrammarDfa(const Grammar& grammar, const Automata::DeterminizeOptions& options)
+	{
+		Automata::SubsetEngine engine;
+		Automata::DeterminizeReport report;
+		Automata::Dfa dfa = engine.Determinize(BuildGrammarNfa(grammar), options, report);
+		if (!report.complete)
+		{
+			throw runtime_error("Determinization budget exceeded: " + to_string(report.expandedStates) + " states expanded");
+		}
+		return dfa;
+	}
+
+	// Без --strategy: построение подмножеств, затем минимизация
+	DFA BuildMinimalDfa(const Grammar& grammar, const Args& args)
+	{
+		if (!args.strategy)
+		{
+			DFA dfa(grammar, args.options);
+			dfa.Minimize();
+			return dfa;
+		}
+		Automata::MinimizeReport report;
+		DFA dfa(grammar, *args.strategy, args.options, report);
+		cout << "Peak DFA states: " << report.peakStates << ", minimal DFA states: " << report.resultStates
+			<< ", peak bytes: " << report.peakBytes << ", time: " << report.milliseconds << " ms" << endl;
+		return dfa;
+	}
+
+	// Пары состояний строятся только по мере надобности, полное произведение не создаётся
+	void RunProduct(const Args& args, const Grammar& grammar)
+	{
+		Automata::Dfa left = BuildGrammarDfa(grammar, args.options);
+		Automata::Dfa right = BuildGrammarDfa(Grammar(args.productFileName, args.grammarSide), args.options);
+		Automata::LazyProduct product(left, right, *args.productOperation);
+
+		if (args.matchInput)
+		{
+			cout << (product.Accepts(*args.matchInput) ? "Accepted" : "Rejected") << endl;
+			return;
+		}
+
+		auto witness = product.FindWitness();
+		if (witness)
+		{
+			cout << "Witness: \"" << *witness << "\"";
+		}
+		else
+		{
+			cout << "Language is empty";
+		}
+		cout << ", product states explored: " << product.GetExploredCount() << " of "
+			<< left.GetStateCount() * right.GetStateCount() << endl;
+	}
+
+	// Для шага сборки: пишется только заголовок, без grammar_output.txt, output.dot и вызова dot
+	void RunCodegen(const Args& args, const Grammar& grammar)
+	{
+		DFA dfa = BuildMinimalDfa(grammar, args);
+		ofstream output(args.codegenFileName);
+		if (!output.is_open())
+		{
+			throw runtime_error("Cannot open file: " + args.codegenFileName);
+		}
+		GenerateCode(dfa.GetCodegenTable(args.codegenName), *args.codegenStyle, output);
+		cout << "Generated matcher in: " << args.codegenFileName << endl;
+	}
+
+	void RunUnion(const Args& args)
+	{
+		vector<Automata::Nfa> patterns;
+		for (const auto& fileName : args.unionFileNames)
+		{
+			patterns.push_back(BuildGrammarNfa(Grammar(fileName, args.grammarSide)));
+		}
+		Automata::MultiPatternDfa dfa(patterns, args.options);
+		cout << "Patterns: " << dfa.GetPatternCount() << ", DFA states: " << dfa.GetDfa().GetStateCount()
+			<< ", distinct accept sets: " << dfa.GetPatternSetCount() << ", symbol classes: " << dfa.GetDfa().GetClassCount()
+			<< " of " << dfa.GetDfa().GetSymbols().size() << endl;
+
+		if (args.matchInput)
+		{
+			auto matched = dfa.Match(*args.matchInput);
+			if (matched.empty())
+			{
+				cout << "Rejected" << endl;
+			}
+			for (int pattern : matched)
+			{
+				cout << "Matched: " << args.unionFileNames[pattern] << endl;
+			}
+		}
+	}
 }
 
 int main(int argc, char* argv[])
@@ -40,10 +241,41 @@ int main(int argc, char* argv[])
 	try
 	{
 		Args args = ParseArgs(argc, argv);
+		if (!args.unionFileNames.empty())
+		{
+			RunUnion(args);
+			return EXIT_SUCCESS;
+		}
 		Grammar grammar(args.fileName, args.grammarSide);
+		if (args.codegenStyle)
+		{
+			RunCodegen(args, grammar);
+			return EXIT_SUCCESS;
+		}
 		grammar.Print("grammar_output.txt");
-		DFA dfa(grammar);
-		dfa.Minimize();
+		if (args.productOperation)
+		{
+			RunProduct(args, grammar);
+			return EXIT_SUCCESS;
+		}
+		if (args.matchInput && args.hasBudget)
+		{
+			// DFA в пределах бюджета, дальше моделирование NFA
+			Automata::HybridExecutor executor(BuildGrammarNfa(grammar), args.options);
+			const auto& report = executor.GetReport();
+			cout << "DFA states expanded: " << report.expandedStates << (report.complete ? "" : " (budget exceeded)")
+				<< ", estimated total: " << report.estimatedStates << ", peak bytes: " << report.peakBytes << endl;
+			cout << (executor.Accepts(*args.matchInput) ? "Accepted" : "Rejected") << endl;
+			return EXIT_SUCCESS;
+		}
+		if (args.matchInput)
+		{
+			// Проверка строки моделированием NFA, без построения DFA
+			Automata::BitParallelNfa matcher(BuildGrammarNfa(grammar));
+			cout << (matcher.Accepts(*args.matchInput) ? "Accepted" : "Rejected") << endl;
+			return EXIT_SUCCESS;
+		}
+		DFA dfa = BuildMinimalDfa(grammar, args);
 		dfa.Print(cout);
 		dfa.Display("output");
 	}